@@ -0,0 +1,341 @@
+/*
+ * bfc benchmark harness
+ * Compiles and runs each workload through every backend of a bfc binary
+ * and prints one JSON object per workload and backend: compile time, run
+ * time, system calls made by the run, executable size and whether the
+ * output matches the native build.
+ * Usage: bench [-n runs] BFC DIR
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <limits.h>
+#include <signal.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+#include <sys/ptrace.h>
+
+#define DEFAULT_RUNS 3
+#define HUGE_SOURCE_SIZE (4 << 20)
+#define MAX_ARGS 8
+
+// A program to measure; `file` and `input` are relative to the workload
+// directory. A NULL file is the generated huge source.
+typedef struct {
+    const char *name;
+    const char *file;
+    const char *input;
+    const char *flags;
+} Workload;
+
+static const Workload workloads[] = {
+    { "mandelbrot", "mandelbrot.b", NULL, "--cell-size=16" },
+    { "hanoi", "hanoi.b", NULL, NULL },
+    { "factor", "factor.b", "factor.in", "--cell-size=16" },
+    { "bench", "bench.b", NULL, NULL },
+    { "long", "long.b", NULL, NULL },
+    { "huge", NULL, NULL, NULL },
+};
+
+typedef enum {
+    BACKEND_NATIVE,         // --elf, then the executable is run
+    BACKEND_JIT,            // --run
+    BACKEND_INTERPRETER,    // --interpret
+    BACKEND_COUNT
+} Backend;
+
+static const char *backend_names[BACKEND_COUNT] = { "native", "jit", "interpreter" };
+static const char *backend_flags[BACKEND_COUNT] = { "--elf", "--run", "--interpret" };
+
+// One measured process
+typedef struct {
+    bool ok;                // exited with status 0
+    double ms;              // CPU time, user plus system
+    long syscalls;          // only counted when traced
+} Measurement;
+
+double cpu_ms(const struct rusage *usage) {
+    return (usage->ru_utime.tv_sec + usage->ru_stime.tv_sec) * 1000.0 +
+           (usage->ru_utime.tv_usec + usage->ru_stime.tv_usec) / 1000.0;
+}
+
+// Count the system calls of a traced child until it exits. Every call
+// stops the child twice, on entry and on exit, except the final exit.
+bool trace_syscalls(pid_t pid, long *syscalls, int *status) {
+    long stops = 0;
+    
+    if (waitpid(pid, status, 0) < 0 || !WIFSTOPPED(*status)) {
+        return false;
+    }
+    ptrace(PTRACE_SETOPTIONS, pid, 0, PTRACE_O_TRACESYSGOOD | PTRACE_O_EXITKILL);
+    int signal = 0;
+    for (;;) {
+        if (ptrace(PTRACE_SYSCALL, pid, 0, signal) < 0 || waitpid(pid, status, 0) < 0) {
+            return false;
+        }
+        if (WIFEXITED(*status) || WIFSIGNALED(*status)) break;
+        signal = 0;
+        if (WSTOPSIG(*status) == (SIGTRAP | 0x80)) {
+            stops++;
+        } else if (WSTOPSIG(*status) != SIGTRAP) {
+            signal = WSTOPSIG(*status);
+        }
+    }
+    *syscalls = (stops + 1) / 2;
+    return true;
+}
+
+// Run argv with stdin and stdout redirected to files (NULL for /dev/null)
+Measurement run_process(char *const argv[], const char *in_path, const char *out_path, bool trace) {
+    Measurement m = { false, 0, -1 };
+    struct rusage usage;
+    
+    pid_t pid = fork();
+    if (pid < 0) {
+        return m;
+    }
+    if (pid == 0) {
+        int in = open(in_path ? in_path : "/dev/null", O_RDONLY);
+        int out = out_path ? open(out_path, O_WRONLY | O_CREAT | O_TRUNC, 0644)
+                           : open("/dev/null", O_WRONLY);
+        if (in < 0 || out < 0 || dup2(in, 0) < 0 || dup2(out, 1) < 0) {
+            _exit(127);
+        }
+        if (trace && ptrace(PTRACE_TRACEME, 0, 0, 0) < 0) {
+            _exit(127);
+        }
+        execv(argv[0], argv);
+        _exit(127);
+    }
+    
+    int status;
+    if (trace) {
+        if (!trace_syscalls(pid, &m.syscalls, &status)) {
+            kill(pid, SIGKILL);
+            waitpid(pid, &status, 0);
+            return m;
+        }
+    } else if (wait4(pid, &status, 0, &usage) < 0) {
+        return m;
+    } else {
+        m.ms = cpu_ms(&usage);
+    }
+    m.ok = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    return m;
+}
+
+// Best of `runs` untraced runs, plus one traced run for the system call
+// count when `count` is set. Tracing slows every call down, so it is kept
+// out of the timing.
+Measurement measure(char *const argv[], const char *in_path, const char *out_path,
+                    int runs, bool count) {
+    Measurement best = { false, 0, -1 };
+    
+    for (int i = 0; i < runs; i++) {
+        Measurement m = run_process(argv, in_path, out_path, false);
+        if (!m.ok) {
+            return m;
+        }
+        if (i == 0 || m.ms < best.ms) best = m;
+    }
+    if (count) {
+        Measurement traced = run_process(argv, in_path, NULL, true);
+        best.syscalls = traced.ok ? traced.syscalls : -1;
+    }
+    return best;
+}
+
+// Write a source of `size` bytes: many small multiply loops, each printing
+// one byte, with comment text between them. It starts with an input so the
+// whole program reaches the code generator.
+bool write_huge_source(const char *path, size_t size) {
+    FILE *f = fopen(path, "w");
+    if (!f) {
+        return false;
+    }
+    
+    uint32_t seed = 1;
+    size_t written = (size_t)fprintf(f, ",[-]\n");
+    for (size_t block = 0; written < size; block++) {
+        seed = seed * 1103515245 + 12345;
+        int outer = (int)(seed >> 16) % 9 + 1;
+        int inner = (int)(seed >> 20) % 7 + 1;
+        written += (size_t)fprintf(f, "%.*s[>%.*s<-]>.[-]<", outer, "+++++++++", inner, "+++++++");
+        if (block % 4 == 3) {
+            written += (size_t)fprintf(f, " block %zu\n", block);
+        }
+    }
+    return fclose(f) == 0;
+}
+
+bool same_contents(const char *a, const char *b) {
+    FILE *fa = fopen(a, "rb");
+    FILE *fb = fopen(b, "rb");
+    bool same = fa && fb;
+    
+    while (same) {
+        int ca = getc(fa);
+        int cb = getc(fb);
+        same = ca == cb;
+        if (ca == EOF) break;
+    }
+    if (fa) fclose(fa);
+    if (fb) fclose(fb);
+    return same;
+}
+
+long long file_size(const char *path) {
+    struct stat st;
+    return stat(path, &st) == 0 ? (long long)st.st_size : -1;
+}
+
+// JSON fields; values that were not measured print as null
+void print_ms(const char *key, double ms, bool valid) {
+    if (valid) {
+        printf(",\"%s\":%.3f", key, ms);
+    } else {
+        printf(",\"%s\":null", key);
+    }
+}
+
+void print_count(const char *key, long long count) {
+    if (count >= 0) {
+        printf(",\"%s\":%lld", key, count);
+    } else {
+        printf(",\"%s\":null", key);
+    }
+}
+
+// Measure one workload through one backend and print its record. The
+// native output is the reference the other backends are compared against.
+bool bench_backend(const char *bfc, const Workload *w, Backend backend, const char *source,
+                   const char *input, const char *temp, int runs) {
+    char exe[PATH_MAX];
+    char out[PATH_MAX];
+    char reference[PATH_MAX];
+    char *argv[MAX_ARGS];
+    int argc = 0;
+    
+    snprintf(exe, sizeof(exe), "%s/%s", temp, w->name);
+    snprintf(out, sizeof(out), "%s/%s.%s.out", temp, w->name, backend_names[backend]);
+    snprintf(reference, sizeof(reference), "%s/%s.%s.out", temp, w->name, backend_names[BACKEND_NATIVE]);
+    
+    argv[argc++] = (char *)bfc;
+    if (w->flags) argv[argc++] = (char *)w->flags;
+    argv[argc++] = (char *)backend_flags[backend];
+    argv[argc++] = (char *)source;
+    if (backend == BACKEND_NATIVE) argv[argc++] = exe;
+    argv[argc] = NULL;
+    
+    Measurement compile = { true, 0, -1 };
+    Measurement run;
+    long long size = -1;
+    if (backend == BACKEND_NATIVE) {
+        compile = measure(argv, NULL, NULL, runs, false);
+        size = file_size(exe);
+        char *run_argv[] = { exe, NULL };
+        run = compile.ok ? measure(run_argv, input, out, runs, true) : compile;
+    } else {
+        run = measure(argv, input, out, runs, true);
+    }
+    bool ok = compile.ok && run.ok && same_contents(out, reference);
+    
+    printf("{\"workload\":\"%s\",\"backend\":\"%s\"", w->name, backend_names[backend]);
+    print_ms("compile_ms", compile.ms, compile.ok && backend == BACKEND_NATIVE);
+    print_ms("run_ms", run.ms, run.ok);
+    print_count("syscalls", run.syscalls);
+    print_count("size", size);
+    print_count("output_bytes", ok ? file_size(out) : -1);
+    printf(",\"ok\":%s}\n", ok ? "true" : "false");
+    fflush(stdout);
+    
+    if (backend != BACKEND_NATIVE) {
+        unlink(out);
+    }
+    return ok;
+}
+
+// Run one workload through every backend; returns the number of failures
+int bench_workload(const char *bfc, const char *dir, const char *temp, const Workload *w, int runs) {
+    char source[PATH_MAX];
+    char input[PATH_MAX];
+    char path[PATH_MAX];
+    int failed = 0;
+    
+    if (w->file) {
+        snprintf(source, sizeof(source), "%s/%s", dir, w->file);
+    } else {
+        snprintf(source, sizeof(source), "%s/%s.b", temp, w->name);
+        if (!write_huge_source(source, HUGE_SOURCE_SIZE)) {
+            fprintf(stderr, "Could not write %s\n", source);
+            return 1;
+        }
+    }
+    if (w->input) {
+        snprintf(input, sizeof(input), "%s/%s", dir, w->input);
+    }
+    
+    for (int b = 0; b < BACKEND_COUNT; b++) {
+        if (!bench_backend(bfc, w, (Backend)b, source, w->input ? input : NULL, temp, runs)) {
+            failed++;
+        }
+    }
+    
+    snprintf(path, sizeof(path), "%s/%s", temp, w->name);
+    unlink(path);
+    snprintf(path, sizeof(path), "%s/%s.%s.out", temp, w->name, backend_names[BACKEND_NATIVE]);
+    unlink(path);
+    if (!w->file) {
+        unlink(source);
+    }
+    return failed;
+}
+
+int usage(const char *program) {
+    fprintf(stderr, "Usage: %s [-n runs] BFC DIR\n", program);
+    fprintf(stderr, "Runs the workloads in DIR through each backend of the compiler BFC\n");
+    fprintf(stderr, "and prints one JSON object per line. Times are the best CPU time of\n");
+    fprintf(stderr, "runs (default %d) in milliseconds; the jit and interpreter run times\n", DEFAULT_RUNS);
+    fprintf(stderr, "include compiling. Exits with 1 if any run fails or disagrees with\n");
+    fprintf(stderr, "the native output.\n");
+    return 1;
+}
+
+int main(int argc, char *argv[]) {
+    int runs = DEFAULT_RUNS;
+    int arg = 1;
+    
+    if (arg + 1 < argc && strcmp(argv[arg], "-n") == 0) {
+        runs = atoi(argv[arg + 1]);
+        arg += 2;
+    }
+    if (argc - arg != 2 || runs < 1) {
+        return usage(argv[0]);
+    }
+    const char *bfc = argv[arg];
+    const char *dir = argv[arg + 1];
+    
+    const char *tmpdir = getenv("TMPDIR");
+    char temp[PATH_MAX];
+    snprintf(temp, sizeof(temp), "%s/bfc-bench.XXXXXX", tmpdir ? tmpdir : "/tmp");
+    if (!mkdtemp(temp)) {
+        fprintf(stderr, "Could not create a temporary directory in %s\n", tmpdir ? tmpdir : "/tmp");
+        return 1;
+    }
+    
+    int failed = 0;
+    for (size_t i = 0; i < sizeof(workloads) / sizeof(workloads[0]); i++) {
+        failed += bench_workload(bfc, dir, temp, &workloads[i], runs);
+    }
+    
+    rmdir(temp);
+    return failed ? 1 : 0;
+}
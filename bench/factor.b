@@ -0,0 +1,81 @@
+Factor
+Reads decimal numbers one per line and prints each followed by its prime
+factors in ascending order by trial division
+Numbers must be below 65025 and need 16 bit cells
+
++[>>>+[>,>+<[->>>+<+<<]>>>[-<<<+>>>]<[<<[->>>>+<+<<<]>>>>[-<<<<+>>>>]<--
+-------->+<[->>>+<+<<]>>>[-<<<+>>>]<[<<<<<<<<[->>>>>>>>>+<<<<<<<<<]>>>>>
+>>>>[-<<<<<<<<<++++++++++>>>>>>>>>]++++++[-<<<<<<-------->>>>>>]<<<<<<[-
+<<<+>>>]<<[-]+>>>>>>[-]>[-]]<[<<<<<[-]>>>>>[-]]<[-]<<<[-]>[-]>[-]]<[<<[-
+]<<<[-]>>>>>[-]]<<]<[->>+<+<]>>[-<<+>>]<[<<[->>>>+<+<<<]>>>>[-<<<<+>>>>]
+<[->>>>+<+<<<]>>>>[-<<<<+>>>>]++++++++++<[->-<<+>>>+<[->>>+<+<<]>>>[-<<<
++>>>]<[<[-]>[-]]<[<++++++++++<<[-]<+>>>>[-]]<<]>[-]<<<<[-]>[->>>>+<+<<<]
+>>>>[-<<<<+>>>>]++++++++++<[->-<<+>>>+<[->>>+<+<<]>>>[-<<<+>>>]<[<[-]>[-
+]]<[<++++++++++<<[-]<<<+>>>>>>[-]]<<]>[-]<<<<[-]<[->>>>>>+<+<<<<<]>>>>>>
+[-<<<<<<+>>>>>>]++++++++++<[->-<<+>>>+<[->>>+<+<<]>>>[-<<<+>>>]<[<[-]>[-
+]]<[<++++++++++<<[-]<<<+>>>>>>[-]]<<]>[-]<<<<<<[-]>[->>>>>>+<+<<<<<]>>>>
+>>[-<<<<<<+>>>>>>]++++++++++<[->-<<+>>>+<[->>>+<+<<]>>>[-<<<+>>>]<[<[-]>
+[-]]<[<++++++++++<<[-]<<<<<+>>>>>>>>[-]]<<]>[-]<<<<<<[-]<[->>>>>>>>+<+<<
+<<<<<]>>>>>>>>[-<<<<<<<<+>>>>>>>>]++++++++++<[->-<<+>>>+<[->>>+<+<<]>>>[
+-<<<+>>>]<[<[-]>[-]]<[<++++++++++<<[-]<<<<<+>>>>>>>>[-]]<<]>[-]<<<<<<<<[
+-]>[-]>>>>>[->+<<<<<<+>>>>>]>[-<+>]<<<<<<[<[-]+>[-]]<[->>>>>>>+<<<<<<+<]
+>>>>>>>[-<<<<<<<+>>>>>>>]<<<<<<[>>>>>>++++++[-<++++++++>]<.<<<<<[-]]>>>>
+>[-]<[->+<<<<<+>>>>]>[-<+>]<<<<<[<[-]+>[-]]<[->>>>>>+<<<<<+<]>>>>>>[-<<<
+<<<+>>>>>>]<<<<<[>>>>>++++++[-<++++++++>]<.<<<<[-]]>>>>[-]<[->+<<<<+>>>]
+>[-<+>]<<<<[<[-]+>[-]]<[->>>>>+<<<<+<]>>>>>[-<<<<<+>>>>>]<<<<[>>>>++++++
+[-<++++++++>]<.<<<[-]]>>>[-]<[->+<<<+>>]>[-<+>]<<<[<[-]+>[-]]<[->>>>+<<<
++<]>>>>[-<<<<+>>>>]<<<[>>>++++++[-<++++++++>]<.<<[-]]>>[-]<<<[-]+>>[->+<
+<+>]>[-<+>]<<[<[-]+>[-]]<[->>>+<<+<]>>>[-<<<+>>>]<<[>>++++++[-<++++++++>
+]<.<[-]]>[-]<<[-]>+++++++[-<++++++++>]<++.[-]++>+[<[->>>>+<+<<<]>>>>[-<<
+<<+>>>>]<[-<<<[->>>>+<<+<<]>>>>[-<<<<+>>>>]<]<<<<<<[->>>>>>>>+<+<<<<<<<]
+>>>>>>>>[-<<<<<<<<+>>>>>>>>]<<<[->>>>+<+<<<]>>>>[-<<<<+>>>>]<[->+<<[->>>
+>+<+<<<]>>>>[-<<<<+>>>>]<[<<<->>[-]>[-]]<[<<<[-]+>>>[-]]<]<[-]<<[-]+>[->
+>+<+<]>>[-<<+>>]<[<<<[-]>[-]>>[-]]<<[<<<<<[->>>>>>>>>>>+<+<<<<<<<<<<]>>>
+>>>>>>>>[-<<<<<<<<<<<+>>>>>>>>>>>]<<<<<<<<[->>>>>>>>>+<+<<<<<<<<]>>>>>>>
+>>[-<<<<<<<<<+>>>>>>>>>]<<[->-<<+>>>+<[->>>+<+<<]>>>[-<<<+>>>]<[<[-]>[-]
+]<[<<<<<<<<<[->>>>>>>>>>+<<+<<<<<<<<]>>>>>>>>>>[-<<<<<<<<<<+>>>>>>>>>>]<
+<<<[-]<+>>>>[-]]<<]>[-]<+<[->>>+<+<<]>>>[-<<<+>>>]<[<<<<<<<<+>>>>>>>[-]>
+[-]]<[>>>+++++[-<++++++>]<++.[-]<<<<<<<<<[->>>>>>>>>>+<+<<<<<<<<<]>>>>>>
+>>>>[-<<<<<<<<<<+>>>>>>>>>>]<[->>>>+<+<<<]>>>>[-<<<<+>>>>]++++++++++<[->
+-<<+>>>+<[->>>+<+<<]>>>[-<<<+>>>]<[<[-]>[-]]<[<++++++++++<<[-]<+>>>>[-]]
+<<]>[-]<<<<[-]>[->>>>+<+<<<]>>>>[-<<<<+>>>>]++++++++++<[->-<<+>>>+<[->>>
++<+<<]>>>[-<<<+>>>]<[<[-]>[-]]<[<++++++++++<<[-]<<<+>>>>>>[-]]<<]>[-]<<<
+<[-]<[->>>>>>+<+<<<<<]>>>>>>[-<<<<<<+>>>>>>]++++++++++<[->-<<+>>>+<[->>>
++<+<<]>>>[-<<<+>>>]<[<[-]>[-]]<[<++++++++++<<[-]<<<+>>>>>>[-]]<<]>[-]<<<
+<<<[-]>[->>>>>>+<+<<<<<]>>>>>>[-<<<<<<+>>>>>>]++++++++++<[->-<<+>>>+<[->
+>>+<+<<]>>>[-<<<+>>>]<[<[-]>[-]]<[<++++++++++<<[-]<<<<<+>>>>>>>>[-]]<<]>
+[-]<<<<<<[-]<[->>>>>>>>+<+<<<<<<<]>>>>>>>>[-<<<<<<<<+>>>>>>>>]++++++++++
+<[->-<<+>>>+<[->>>+<+<<]>>>[-<<<+>>>]<[<[-]>[-]]<[<++++++++++<<[-]<<<<<+
+>>>>>>>>[-]]<<]>[-]<<<<<<<<[-]>[-]>>>>>[->+<<<<<<+>>>>>]>[-<+>]<<<<<<[<[
+-]+>[-]]<[->>>>>>>+<<<<<<+<]>>>>>>>[-<<<<<<<+>>>>>>>]<<<<<<[>>>>>>++++++
+[-<++++++++>]<.<<<<<[-]]>>>>>[-]<[->+<<<<<+>>>>]>[-<+>]<<<<<[<[-]+>[-]]<
+[->>>>>>+<<<<<+<]>>>>>>[-<<<<<<+>>>>>>]<<<<<[>>>>>++++++[-<++++++++>]<.<
+<<<[-]]>>>>[-]<[->+<<<<+>>>]>[-<+>]<<<<[<[-]+>[-]]<[->>>>>+<<<<+<]>>>>>[
+-<<<<<+>>>>>]<<<<[>>>>++++++[-<++++++++>]<.<<<[-]]>>>[-]<[->+<<<+>>]>[-<
++>]<<<[<[-]+>[-]]<[->>>>+<<<+<]>>>>[-<<<<+>>>>]<<<[>>>++++++[-<++++++++>
+]<.<<[-]]>>[-]<<<[-]+>>[->+<<+>]>[-<+>]<<[<[-]+>[-]]<[->>>+<<+<]>>>[-<<<
++>>>]<<[>>++++++[-<++++++++>]<.<[-]]>[-]<<[-]<<<<<<<<<<<<[-]>>>>>>>>[-<<
+<<<<<<+>>>>>>>>]>>[-]]<<[-]>[-]<<<<[-]]>[-]<<]>+[->>+<+<]>>[-<<+>>]<<<<<
+<<[->>>>>>>>+<+<<<<<<<]>>>>>>>>[-<<<<<<<<+>>>>>>>>]<[->+<<[->>>>+<+<<<]>
+>>>[-<<<<+>>>>]<[<<<->>[-]>[-]]<[<<<<[-]+>>>>[-]]<]<[-]<[-]<[->>+<+<]>>[
+-<<+>>]<[>>+++++[-<++++++>]<++.[-]<<<<<<[->>>>>>>+<+<<<<<<]>>>>>>>[-<<<<
+<<<+>>>>>>>]<[->>>>+<+<<<]>>>>[-<<<<+>>>>]++++++++++<[->-<<+>>>+<[->>>+<
++<<]>>>[-<<<+>>>]<[<[-]>[-]]<[<++++++++++<<[-]<+>>>>[-]]<<]>[-]<<<<[-]>[
+->>>>+<+<<<]>>>>[-<<<<+>>>>]++++++++++<[->-<<+>>>+<[->>>+<+<<]>>>[-<<<+>
+>>]<[<[-]>[-]]<[<++++++++++<<[-]<<<+>>>>>>[-]]<<]>[-]<<<<[-]<[->>>>>>+<+
+<<<<<]>>>>>>[-<<<<<<+>>>>>>]++++++++++<[->-<<+>>>+<[->>>+<+<<]>>>[-<<<+>
+>>]<[<[-]>[-]]<[<++++++++++<<[-]<<<+>>>>>>[-]]<<]>[-]<<<<<<[-]>[->>>>>>+
+<+<<<<<]>>>>>>[-<<<<<<+>>>>>>]++++++++++<[->-<<+>>>+<[->>>+<+<<]>>>[-<<<
++>>>]<[<[-]>[-]]<[<++++++++++<<[-]<<<<<+>>>>>>>>[-]]<<]>[-]<<<<<<[-]<[->
+>>>>>>>+<+<<<<<<<]>>>>>>>>[-<<<<<<<<+>>>>>>>>]++++++++++<[->-<<+>>>+<[->
+>>+<+<<]>>>[-<<<+>>>]<[<[-]>[-]]<[<++++++++++<<[-]<<<<<+>>>>>>>>[-]]<<]>
+[-]<<<<<<<<[-]>[-]>>>>>[->+<<<<<<+>>>>>]>[-<+>]<<<<<<[<[-]+>[-]]<[->>>>>
+>>+<<<<<<+<]>>>>>>>[-<<<<<<<+>>>>>>>]<<<<<<[>>>>>>++++++[-<++++++++>]<.<
+<<<<[-]]>>>>>[-]<[->+<<<<<+>>>>]>[-<+>]<<<<<[<[-]+>[-]]<[->>>>>>+<<<<<+<
+]>>>>>>[-<<<<<<+>>>>>>]<<<<<[>>>>>++++++[-<++++++++>]<.<<<<[-]]>>>>[-]<[
+->+<<<<+>>>]>[-<+>]<<<<[<[-]+>[-]]<[->>>>>+<<<<+<]>>>>>[-<<<<<+>>>>>]<<<
+<[>>>>++++++[-<++++++++>]<.<<<[-]]>>>[-]<[->+<<<+>>]>[-<+>]<<<[<[-]+>[-]
+]<[->>>>+<<<+<]>>>>[-<<<<+>>>>]<<<[>>>++++++[-<++++++++>]<.<<[-]]>>[-]<<
+<[-]+>>[->+<<+>]>[-<+>]<<[<[-]+>[-]]<[->>>+<<+<]>>>[-<<<+>>>]<<[>>++++++
+[-<++++++++>]<.<[-]]>[-]<<[-]<[-]]<[-]++++++++++.[-]<[-]<[-]]<<[-]>[-]<<
+]
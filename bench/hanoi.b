@@ -0,0 +1,212 @@
+Towers of Hanoi
+Solves the puzzle for 16 disks and prints each of the 65535 moves as the
+disk number and the pegs it moves from and to
+Move k takes disk t plus 1 where t is the number of trailing zero bits of k
+from peg (k and k minus 1) mod 3 to peg ((k or k minus 1) plus 1) mod 3
+The counter is kept one bit per cell so 8 bit cells suffice
+
+>>>>>>>>>>>>>>>>>+[>+[->>+<+<]>>[-<<+>>]<[>+<<<<<<<<<<<<<<<<<<<<[->>>>>>
+>>>>>>>>>>>>>>>+<-<<<<<<<<<<<<<<<<<<<<]>>>>>>>>>>>>>>>>>>>>>[-<<<<<<<<<<
+<<<<<<<<<<<+>>>>>>>>>>>>>>>>>>>>>]<<<<<<<<<<<<<<<<<<<<<[-]>>>>>>>>>>>>>>
+>>>>>>[-<<<<<<<<<<<<<<<<<<<<+>>>>>>>>>>>>>>>>>>>>]<<<<<<<<<<<<<<<<<<<<[-
+>>>>>>>>>>>>>>>>>>>>>+<+<<<<<<<<<<<<<<<<<<<<]>>>>>>>>>>>>>>>>>>>>>[-<<<<
+<<<<<<<<<<<<<<<<<+>>>>>>>>>>>>>>>>>>>>>]<[<<[-]>>[-]]<[-]]<[->>+<+<]>>[-
+<<+>>]<[>+<<<<<<<<<<<<<<<<<<<[->>>>>>>>>>>>>>>>>>>>+<-<<<<<<<<<<<<<<<<<<
+<]>>>>>>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<<<<<+>>>>>>>>>>>>>>>>>>>>]<<<<<<
+<<<<<<<<<<<<<<[-]>>>>>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<<<<+>>>>>>>>>>>>>>
+>>>>>]<<<<<<<<<<<<<<<<<<<[->>>>>>>>>>>>>>>>>>>>+<+<<<<<<<<<<<<<<<<<<<]>>
+>>>>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<<<<<+>>>>>>>>>>>>>>>>>>>>]<[<<[-]>>[
+-]]<[-]]<[->>+<+<]>>[-<<+>>]<[>+<<<<<<<<<<<<<<<<<<[->>>>>>>>>>>>>>>>>>>+
+<-<<<<<<<<<<<<<<<<<<]>>>>>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<<<<+>>>>>>>>>>
+>>>>>>>>>]<<<<<<<<<<<<<<<<<<<[-]>>>>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<<<+>
+>>>>>>>>>>>>>>>>>]<<<<<<<<<<<<<<<<<<[->>>>>>>>>>>>>>>>>>>+<+<<<<<<<<<<<<
+<<<<<<]>>>>>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<<<<+>>>>>>>>>>>>>>>>>>>]<[<<
+[-]>>[-]]<[-]]<[->>+<+<]>>[-<<+>>]<[>+<<<<<<<<<<<<<<<<<[->>>>>>>>>>>>>>>
+>>>+<-<<<<<<<<<<<<<<<<<]>>>>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<<<+>>>>>>>>>
+>>>>>>>>>]<<<<<<<<<<<<<<<<<<[-]>>>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<<+>>>>
+>>>>>>>>>>>>>]<<<<<<<<<<<<<<<<<[->>>>>>>>>>>>>>>>>>+<+<<<<<<<<<<<<<<<<<]
+>>>>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<<<+>>>>>>>>>>>>>>>>>>]<[<<[-]>>[-]]<
+[-]]<[->>+<+<]>>[-<<+>>]<[>+<<<<<<<<<<<<<<<<[->>>>>>>>>>>>>>>>>+<-<<<<<<
+<<<<<<<<<<]>>>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<<+>>>>>>>>>>>>>>>>>]<<<<<<
+<<<<<<<<<<<[-]>>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<+>>>>>>>>>>>>>>>>]<<<<<<
+<<<<<<<<<<[->>>>>>>>>>>>>>>>>+<+<<<<<<<<<<<<<<<<]>>>>>>>>>>>>>>>>>[-<<<<
+<<<<<<<<<<<<<+>>>>>>>>>>>>>>>>>]<[<<[-]>>[-]]<[-]]<[->>+<+<]>>[-<<+>>]<[
+>+<<<<<<<<<<<<<<<[->>>>>>>>>>>>>>>>+<-<<<<<<<<<<<<<<<]>>>>>>>>>>>>>>>>[-
+<<<<<<<<<<<<<<<<+>>>>>>>>>>>>>>>>]<<<<<<<<<<<<<<<<[-]>>>>>>>>>>>>>>>[-<<
+<<<<<<<<<<<<<+>>>>>>>>>>>>>>>]<<<<<<<<<<<<<<<[->>>>>>>>>>>>>>>>+<+<<<<<<
+<<<<<<<<<]>>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<+>>>>>>>>>>>>>>>>]<[<<[-]>>[
+-]]<[-]]<[->>+<+<]>>[-<<+>>]<[>+<<<<<<<<<<<<<<[->>>>>>>>>>>>>>>+<-<<<<<<
+<<<<<<<<]>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<+>>>>>>>>>>>>>>>]<<<<<<<<<<<<<<
+<[-]>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<+>>>>>>>>>>>>>>]<<<<<<<<<<<<<<[->>>>>>
+>>>>>>>>>+<+<<<<<<<<<<<<<<]>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<+>>>>>>>>>>>>
+>>>]<[<<[-]>>[-]]<[-]]<[->>+<+<]>>[-<<+>>]<[>+<<<<<<<<<<<<<[->>>>>>>>>>>
+>>>+<-<<<<<<<<<<<<<]>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<+>>>>>>>>>>>>>>]<<<<<<
+<<<<<<<<[-]>>>>>>>>>>>>>[-<<<<<<<<<<<<<+>>>>>>>>>>>>>]<<<<<<<<<<<<<[->>>
+>>>>>>>>>>>+<+<<<<<<<<<<<<<]>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<+>>>>>>>>>>>>>
+>]<[<<[-]>>[-]]<[-]]<[->>+<+<]>>[-<<+>>]<[>+<<<<<<<<<<<<[->>>>>>>>>>>>>+
+<-<<<<<<<<<<<<]>>>>>>>>>>>>>[-<<<<<<<<<<<<<+>>>>>>>>>>>>>]<<<<<<<<<<<<<[
+-]>>>>>>>>>>>>[-<<<<<<<<<<<<+>>>>>>>>>>>>]<<<<<<<<<<<<[->>>>>>>>>>>>>+<+
+<<<<<<<<<<<<]>>>>>>>>>>>>>[-<<<<<<<<<<<<<+>>>>>>>>>>>>>]<[<<[-]>>[-]]<[-
+]]<[->>+<+<]>>[-<<+>>]<[>+<<<<<<<<<<<[->>>>>>>>>>>>+<-<<<<<<<<<<<]>>>>>>
+>>>>>>[-<<<<<<<<<<<<+>>>>>>>>>>>>]<<<<<<<<<<<<[-]>>>>>>>>>>>[-<<<<<<<<<<
+<+>>>>>>>>>>>]<<<<<<<<<<<[->>>>>>>>>>>>+<+<<<<<<<<<<<]>>>>>>>>>>>>[-<<<<
+<<<<<<<<+>>>>>>>>>>>>]<[<<[-]>>[-]]<[-]]<[->>+<+<]>>[-<<+>>]<[>+<<<<<<<<
+<<[->>>>>>>>>>>+<-<<<<<<<<<<]>>>>>>>>>>>[-<<<<<<<<<<<+>>>>>>>>>>>]<<<<<<
+<<<<<[-]>>>>>>>>>>[-<<<<<<<<<<+>>>>>>>>>>]<<<<<<<<<<[->>>>>>>>>>>+<+<<<<
+<<<<<<]>>>>>>>>>>>[-<<<<<<<<<<<+>>>>>>>>>>>]<[<<[-]>>[-]]<[-]]<[->>+<+<]
+>>[-<<+>>]<[>+<<<<<<<<<[->>>>>>>>>>+<-<<<<<<<<<]>>>>>>>>>>[-<<<<<<<<<<+>
+>>>>>>>>>]<<<<<<<<<<[-]>>>>>>>>>[-<<<<<<<<<+>>>>>>>>>]<<<<<<<<<[->>>>>>>
+>>>+<+<<<<<<<<<]>>>>>>>>>>[-<<<<<<<<<<+>>>>>>>>>>]<[<<[-]>>[-]]<[-]]<[->
+>+<+<]>>[-<<+>>]<[>+<<<<<<<<[->>>>>>>>>+<-<<<<<<<<]>>>>>>>>>[-<<<<<<<<<+
+>>>>>>>>>]<<<<<<<<<[-]>>>>>>>>[-<<<<<<<<+>>>>>>>>]<<<<<<<<[->>>>>>>>>+<+
+<<<<<<<<]>>>>>>>>>[-<<<<<<<<<+>>>>>>>>>]<[<<[-]>>[-]]<[-]]<[->>+<+<]>>[-
+<<+>>]<[>+<<<<<<<[->>>>>>>>+<-<<<<<<<]>>>>>>>>[-<<<<<<<<+>>>>>>>>]<<<<<<
+<<[-]>>>>>>>[-<<<<<<<+>>>>>>>]<<<<<<<[->>>>>>>>+<+<<<<<<<]>>>>>>>>[-<<<<
+<<<<+>>>>>>>>]<[<<[-]>>[-]]<[-]]<[->>+<+<]>>[-<<+>>]<[>+<<<<<<[->>>>>>>+
+<-<<<<<<]>>>>>>>[-<<<<<<<+>>>>>>>]<<<<<<<[-]>>>>>>[-<<<<<<+>>>>>>]<<<<<<
+[->>>>>>>+<+<<<<<<]>>>>>>>[-<<<<<<<+>>>>>>>]<[<<[-]>>[-]]<[-]]<[->>+<+<]
+>>[-<<+>>]<[>+<<<<<[->>>>>>+<-<<<<<]>>>>>>[-<<<<<<+>>>>>>]<<<<<<[-]>>>>>
+[-<<<<<+>>>>>]<<<<<[->>>>>>+<+<<<<<]>>>>>>[-<<<<<<+>>>>>>]<[<<[-]>>[-]]<
+[-]]<[->>+<+<]>>[-<<+>>]<[<<[-]<[-]+>>>[-]]<[-]+<<[->>>>+<+<<<]>>>>[-<<<
+<+>>>>]<[<[-]>[-]]<[>+>>+<<<<<<<<<<<<<<<<<<<<<[->>>>>>>>>>>>>>>>>>>>>>>>
++<+<<<<<<<<<<<<<<<<<<<<<<<]>>>>>>>>>>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<<<<
+<<<<<+>>>>>>>>>>>>>>>>>>>>>>>>]<<<<<[->>>>>>+<+<<<<<]>>>>>>[-<<<<<<+>>>>
+>>]<[<<+>>>+<<[->>>+<-<<]>>>[-<<<+>>>]<<<[-]>>[-<<+>>]<<<<<<<<<<<<<<<<<<
+<<<<<<<[->>>>>>>>>>>>>>>>>>>>>>>>>>+<+<<<<<<<<<<<<<<<<<<<<<<<<<]>>>>>>>>
+>>>>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<<<<<<<<<<<+>>>>>>>>>>>>>>>>>>>>>>>>>
+>]<[<<<<<<[-]>>>>>>[-]]<[-]]<<<<<<<<<<<<<<<<<<<<<<<<[->>>>>>>>>>>>>>>>>>
+>>>>>>>+<+<<<<<<<<<<<<<<<<<<<<<<<<]>>>>>>>>>>>>>>>>>>>>>>>>>[-<<<<<<<<<<
+<<<<<<<<<<<<<<<+>>>>>>>>>>>>>>>>>>>>>>>>>]<<[->>+<+<]>>[-<<+>>]<[->>+<+<
+]>>[-<<+>>]<[<<<<+>>>-[->>>+<+<<]>>>[-<<<+>>>]<[<<<<<<+>>>>>>[-]]<<[-]>[
+-]]<<[-]<<<<<<<<<<<<<<<<<<<<<<[->>>>>>>>>>>>>>>>>>>>>>>+<+<<<<<<<<<<<<<<
+<<<<<<<<]>>>>>>>>>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<<<<<<<<+>>>>>>>>>>>>>>
+>>>>>>>>>]<<<<<[->>>>>>+<+<<<<<]>>>>>>[-<<<<<<+>>>>>>]<[<<+>>>+<<[->>>+<
+-<<]>>>[-<<<+>>>]<<<[-]>>[-<<+>>]<<<<<<<<<<<<<<<<<<<<<<<<[->>>>>>>>>>>>>
+>>>>>>>>>>>>+<+<<<<<<<<<<<<<<<<<<<<<<<<]>>>>>>>>>>>>>>>>>>>>>>>>>[-<<<<<
+<<<<<<<<<<<<<<<<<<<<+>>>>>>>>>>>>>>>>>>>>>>>>>]<[<<<<<<[-]>>>>>>[-]]<[-]
+]<<<<<<<<<<<<<<<<<<<<<<<[->>>>>>>>>>>>>>>>>>>>>>>>+<+<<<<<<<<<<<<<<<<<<<
+<<<<]>>>>>>>>>>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<<<<<<<<<+>>>>>>>>>>>>>>>>
+>>>>>>>>]<<[->>+<+<]>>[-<<+>>]<[->>+<+<]>>[-<<+>>]<[<<<<++>>>-[->>>+<+<<
+]>>>[-<<<+>>>]<[<<<<<<++>>>>>>[-]]<<[-]>[-]]<<[-]<<<<<<<<<<<<<<<<<<<<<[-
+>>>>>>>>>>>>>>>>>>>>>>+<+<<<<<<<<<<<<<<<<<<<<<]>>>>>>>>>>>>>>>>>>>>>>[-<
+<<<<<<<<<<<<<<<<<<<<<+>>>>>>>>>>>>>>>>>>>>>>]<<<<<[->>>>>>+<+<<<<<]>>>>>
+>[-<<<<<<+>>>>>>]<[<<+>>>+<<[->>>+<-<<]>>>[-<<<+>>>]<<<[-]>>[-<<+>>]<<<<
+<<<<<<<<<<<<<<<<<<<[->>>>>>>>>>>>>>>>>>>>>>>>+<+<<<<<<<<<<<<<<<<<<<<<<<]
+>>>>>>>>>>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<<<<<<<<<+>>>>>>>>>>>>>>>>>>>>>
+>>>]<[<<<<<<[-]>>>>>>[-]]<[-]]<<<<<<<<<<<<<<<<<<<<<<[->>>>>>>>>>>>>>>>>>
+>>>>>+<+<<<<<<<<<<<<<<<<<<<<<<]>>>>>>>>>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<
+<<<<<<<+>>>>>>>>>>>>>>>>>>>>>>>]<<[->>+<+<]>>[-<<+>>]<[->>+<+<]>>[-<<+>>
+]<[<<<<+>>>-[->>>+<+<<]>>>[-<<<+>>>]<[<<<<<<+>>>>>>[-]]<<[-]>[-]]<<[-]<<
+<<<<<<<<<<<<<<<<<<[->>>>>>>>>>>>>>>>>>>>>+<+<<<<<<<<<<<<<<<<<<<<]>>>>>>>
+>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<<<<<<+>>>>>>>>>>>>>>>>>>>>>]<<<<<[->>>>>
+>+<+<<<<<]>>>>>>[-<<<<<<+>>>>>>]<[<<+>>>+<<[->>>+<-<<]>>>[-<<<+>>>]<<<[-
+]>>[-<<+>>]<<<<<<<<<<<<<<<<<<<<<<[->>>>>>>>>>>>>>>>>>>>>>>+<+<<<<<<<<<<<
+<<<<<<<<<<<]>>>>>>>>>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<<<<<<<<+>>>>>>>>>>>
+>>>>>>>>>>>>]<[<<<<<<[-]>>>>>>[-]]<[-]]<<<<<<<<<<<<<<<<<<<<<[->>>>>>>>>>
+>>>>>>>>>>>>+<+<<<<<<<<<<<<<<<<<<<<<]>>>>>>>>>>>>>>>>>>>>>>[-<<<<<<<<<<<
+<<<<<<<<<<<+>>>>>>>>>>>>>>>>>>>>>>]<<[->>+<+<]>>[-<<+>>]<[->>+<+<]>>[-<<
++>>]<[<<<<++>>>-[->>>+<+<<]>>>[-<<<+>>>]<[<<<<<<++>>>>>>[-]]<<[-]>[-]]<<
+[-]<<<<<<<<<<<<<<<<<<<[->>>>>>>>>>>>>>>>>>>>+<+<<<<<<<<<<<<<<<<<<<]>>>>>
+>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<<<<<+>>>>>>>>>>>>>>>>>>>>]<<<<<[->>>>>>
++<+<<<<<]>>>>>>[-<<<<<<+>>>>>>]<[<<+>>>+<<[->>>+<-<<]>>>[-<<<+>>>]<<<[-]
+>>[-<<+>>]<<<<<<<<<<<<<<<<<<<<<[->>>>>>>>>>>>>>>>>>>>>>+<+<<<<<<<<<<<<<<
+<<<<<<<]>>>>>>>>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<<<<<<<+>>>>>>>>>>>>>>>>>
+>>>>>]<[<<<<<<[-]>>>>>>[-]]<[-]]<<<<<<<<<<<<<<<<<<<<[->>>>>>>>>>>>>>>>>>
+>>>+<+<<<<<<<<<<<<<<<<<<<<]>>>>>>>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<<<<<<+
+>>>>>>>>>>>>>>>>>>>>>]<<[->>+<+<]>>[-<<+>>]<[->>+<+<]>>[-<<+>>]<[<<<<+>>
+>-[->>>+<+<<]>>>[-<<<+>>>]<[<<<<<<+>>>>>>[-]]<<[-]>[-]]<<[-]<<<<<<<<<<<<
+<<<<<<[->>>>>>>>>>>>>>>>>>>+<+<<<<<<<<<<<<<<<<<<]>>>>>>>>>>>>>>>>>>>[-<<
+<<<<<<<<<<<<<<<<<+>>>>>>>>>>>>>>>>>>>]<<<<<[->>>>>>+<+<<<<<]>>>>>>[-<<<<
+<<+>>>>>>]<[<<+>>>+<<[->>>+<-<<]>>>[-<<<+>>>]<<<[-]>>[-<<+>>]<<<<<<<<<<<
+<<<<<<<<<[->>>>>>>>>>>>>>>>>>>>>+<+<<<<<<<<<<<<<<<<<<<<]>>>>>>>>>>>>>>>>
+>>>>>[-<<<<<<<<<<<<<<<<<<<<<+>>>>>>>>>>>>>>>>>>>>>]<[<<<<<<[-]>>>>>>[-]]
+<[-]]<<<<<<<<<<<<<<<<<<<[->>>>>>>>>>>>>>>>>>>>+<+<<<<<<<<<<<<<<<<<<<]>>>
+>>>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<<<<<+>>>>>>>>>>>>>>>>>>>>]<<[->>+<+<]
+>>[-<<+>>]<[->>+<+<]>>[-<<+>>]<[<<<<++>>>-[->>>+<+<<]>>>[-<<<+>>>]<[<<<<
+<<++>>>>>>[-]]<<[-]>[-]]<<[-]<<<<<<<<<<<<<<<<<[->>>>>>>>>>>>>>>>>>+<+<<<
+<<<<<<<<<<<<<<]>>>>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<<<+>>>>>>>>>>>>>>>>>>
+]<<<<<[->>>>>>+<+<<<<<]>>>>>>[-<<<<<<+>>>>>>]<[<<+>>>+<<[->>>+<-<<]>>>[-
+<<<+>>>]<<<[-]>>[-<<+>>]<<<<<<<<<<<<<<<<<<<[->>>>>>>>>>>>>>>>>>>>+<+<<<<
+<<<<<<<<<<<<<<<]>>>>>>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<<<<<+>>>>>>>>>>>>>
+>>>>>>>]<[<<<<<<[-]>>>>>>[-]]<[-]]<<<<<<<<<<<<<<<<<<[->>>>>>>>>>>>>>>>>>
+>+<+<<<<<<<<<<<<<<<<<<]>>>>>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<<<<+>>>>>>>>
+>>>>>>>>>>>]<<[->>+<+<]>>[-<<+>>]<[->>+<+<]>>[-<<+>>]<[<<<<+>>>-[->>>+<+
+<<]>>>[-<<<+>>>]<[<<<<<<+>>>>>>[-]]<<[-]>[-]]<<[-]<<<<<<<<<<<<<<<<[->>>>
+>>>>>>>>>>>>>+<+<<<<<<<<<<<<<<<<]>>>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<<+>>
+>>>>>>>>>>>>>>>]<<<<<[->>>>>>+<+<<<<<]>>>>>>[-<<<<<<+>>>>>>]<[<<+>>>+<<[
+->>>+<-<<]>>>[-<<<+>>>]<<<[-]>>[-<<+>>]<<<<<<<<<<<<<<<<<<[->>>>>>>>>>>>>
+>>>>>>+<+<<<<<<<<<<<<<<<<<<]>>>>>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<<<<+>>>
+>>>>>>>>>>>>>>>>]<[<<<<<<[-]>>>>>>[-]]<[-]]<<<<<<<<<<<<<<<<<[->>>>>>>>>>
+>>>>>>>>+<+<<<<<<<<<<<<<<<<<]>>>>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<<<+>>>>
+>>>>>>>>>>>>>>]<<[->>+<+<]>>[-<<+>>]<[->>+<+<]>>[-<<+>>]<[<<<<++>>>-[->>
+>+<+<<]>>>[-<<<+>>>]<[<<<<<<++>>>>>>[-]]<<[-]>[-]]<<[-]<<<<<<<<<<<<<<<[-
+>>>>>>>>>>>>>>>>+<+<<<<<<<<<<<<<<<]>>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<+>>
+>>>>>>>>>>>>>>]<<<<<[->>>>>>+<+<<<<<]>>>>>>[-<<<<<<+>>>>>>]<[<<+>>>+<<[-
+>>>+<-<<]>>>[-<<<+>>>]<<<[-]>>[-<<+>>]<<<<<<<<<<<<<<<<<[->>>>>>>>>>>>>>>
+>>>+<+<<<<<<<<<<<<<<<<<]>>>>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<<<+>>>>>>>>>
+>>>>>>>>>]<[<<<<<<[-]>>>>>>[-]]<[-]]<<<<<<<<<<<<<<<<[->>>>>>>>>>>>>>>>>+
+<+<<<<<<<<<<<<<<<<]>>>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<<+>>>>>>>>>>>>>>>>
+>]<<[->>+<+<]>>[-<<+>>]<[->>+<+<]>>[-<<+>>]<[<<<<+>>>-[->>>+<+<<]>>>[-<<
+<+>>>]<[<<<<<<+>>>>>>[-]]<<[-]>[-]]<<[-]<<<<<<<<<<<<<<[->>>>>>>>>>>>>>>+
+<+<<<<<<<<<<<<<<]>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<+>>>>>>>>>>>>>>>]<<<<<[
+->>>>>>+<+<<<<<]>>>>>>[-<<<<<<+>>>>>>]<[<<+>>>+<<[->>>+<-<<]>>>[-<<<+>>>
+]<<<[-]>>[-<<+>>]<<<<<<<<<<<<<<<<[->>>>>>>>>>>>>>>>>+<+<<<<<<<<<<<<<<<<]
+>>>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<<+>>>>>>>>>>>>>>>>>]<[<<<<<<[-]>>>>>>
+[-]]<[-]]<<<<<<<<<<<<<<<[->>>>>>>>>>>>>>>>+<+<<<<<<<<<<<<<<<]>>>>>>>>>>>
+>>>>>[-<<<<<<<<<<<<<<<<+>>>>>>>>>>>>>>>>]<<[->>+<+<]>>[-<<+>>]<[->>+<+<]
+>>[-<<+>>]<[<<<<++>>>-[->>>+<+<<]>>>[-<<<+>>>]<[<<<<<<++>>>>>>[-]]<<[-]>
+[-]]<<[-]<<<<<<<<<<<<<[->>>>>>>>>>>>>>+<+<<<<<<<<<<<<<]>>>>>>>>>>>>>>[-<
+<<<<<<<<<<<<<+>>>>>>>>>>>>>>]<<<<<[->>>>>>+<+<<<<<]>>>>>>[-<<<<<<+>>>>>>
+]<[<<+>>>+<<[->>>+<-<<]>>>[-<<<+>>>]<<<[-]>>[-<<+>>]<<<<<<<<<<<<<<<[->>>
+>>>>>>>>>>>>>+<+<<<<<<<<<<<<<<<]>>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<+>>>>>
+>>>>>>>>>>>]<[<<<<<<[-]>>>>>>[-]]<[-]]<<<<<<<<<<<<<<[->>>>>>>>>>>>>>>+<+
+<<<<<<<<<<<<<<]>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<+>>>>>>>>>>>>>>>]<<[->>+<
++<]>>[-<<+>>]<[->>+<+<]>>[-<<+>>]<[<<<<+>>>-[->>>+<+<<]>>>[-<<<+>>>]<[<<
+<<<<+>>>>>>[-]]<<[-]>[-]]<<[-]<<<<<<<<<<<<[->>>>>>>>>>>>>+<+<<<<<<<<<<<<
+]>>>>>>>>>>>>>[-<<<<<<<<<<<<<+>>>>>>>>>>>>>]<<<<<[->>>>>>+<+<<<<<]>>>>>>
+[-<<<<<<+>>>>>>]<[<<+>>>+<<[->>>+<-<<]>>>[-<<<+>>>]<<<[-]>>[-<<+>>]<<<<<
+<<<<<<<<<[->>>>>>>>>>>>>>>+<+<<<<<<<<<<<<<<]>>>>>>>>>>>>>>>[-<<<<<<<<<<<
+<<<<+>>>>>>>>>>>>>>>]<[<<<<<<[-]>>>>>>[-]]<[-]]<<<<<<<<<<<<<[->>>>>>>>>>
+>>>>+<+<<<<<<<<<<<<<]>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<+>>>>>>>>>>>>>>]<<[->
+>+<+<]>>[-<<+>>]<[->>+<+<]>>[-<<+>>]<[<<<<++>>>-[->>>+<+<<]>>>[-<<<+>>>]
+<[<<<<<<++>>>>>>[-]]<<[-]>[-]]<<[-]<<<<<<<<<<<[->>>>>>>>>>>>+<+<<<<<<<<<
+<<]>>>>>>>>>>>>[-<<<<<<<<<<<<+>>>>>>>>>>>>]<<<<<[->>>>>>+<+<<<<<]>>>>>>[
+-<<<<<<+>>>>>>]<[<<+>>>+<<[->>>+<-<<]>>>[-<<<+>>>]<<<[-]>>[-<<+>>]<<<<<<
+<<<<<<<[->>>>>>>>>>>>>>+<+<<<<<<<<<<<<<]>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<+>
+>>>>>>>>>>>>>]<[<<<<<<[-]>>>>>>[-]]<[-]]<<<<<<<<<<<<[->>>>>>>>>>>>>+<+<<
+<<<<<<<<<<]>>>>>>>>>>>>>[-<<<<<<<<<<<<<+>>>>>>>>>>>>>]<<[->>+<+<]>>[-<<+
+>>]<[->>+<+<]>>[-<<+>>]<[<<<<+>>>-[->>>+<+<<]>>>[-<<<+>>>]<[<<<<<<+>>>>>
+>[-]]<<[-]>[-]]<<[-]<<<<<<<<<<[->>>>>>>>>>>+<+<<<<<<<<<<]>>>>>>>>>>>[-<<
+<<<<<<<<<+>>>>>>>>>>>]<<<<<[->>>>>>+<+<<<<<]>>>>>>[-<<<<<<+>>>>>>]<[<<+>
+>>+<<[->>>+<-<<]>>>[-<<<+>>>]<<<[-]>>[-<<+>>]<<<<<<<<<<<<[->>>>>>>>>>>>>
++<+<<<<<<<<<<<<]>>>>>>>>>>>>>[-<<<<<<<<<<<<<+>>>>>>>>>>>>>]<[<<<<<<[-]>>
+>>>>[-]]<[-]]<<<<<<<<<<<[->>>>>>>>>>>>+<+<<<<<<<<<<<]>>>>>>>>>>>>[-<<<<<
+<<<<<<<+>>>>>>>>>>>>]<<[->>+<+<]>>[-<<+>>]<[->>+<+<]>>[-<<+>>]<[<<<<++>>
+>-[->>>+<+<<]>>>[-<<<+>>>]<[<<<<<<++>>>>>>[-]]<<[-]>[-]]<<[-]<<<<<<<<<[-
+>>>>>>>>>>+<+<<<<<<<<<]>>>>>>>>>>[-<<<<<<<<<<+>>>>>>>>>>]<<<<<[->>>>>>+<
++<<<<<]>>>>>>[-<<<<<<+>>>>>>]<[<<+>>>+<<[->>>+<-<<]>>>[-<<<+>>>]<<<[-]>>
+[-<<+>>]<<<<<<<<<<<[->>>>>>>>>>>>+<+<<<<<<<<<<<]>>>>>>>>>>>>[-<<<<<<<<<<
+<<+>>>>>>>>>>>>]<[<<<<<<[-]>>>>>>[-]]<[-]]<<<<<<<<<<[->>>>>>>>>>>+<+<<<<
+<<<<<<]>>>>>>>>>>>[-<<<<<<<<<<<+>>>>>>>>>>>]<<[->>+<+<]>>[-<<+>>]<[->>+<
++<]>>[-<<+>>]<[<<<<+>>>-[->>>+<+<<]>>>[-<<<+>>>]<[<<<<<<+>>>>>>[-]]<<[-]
+>[-]]<<[-]<<<<<<<<[->>>>>>>>>+<+<<<<<<<<]>>>>>>>>>[-<<<<<<<<<+>>>>>>>>>]
+<<<<<[->>>>>>+<+<<<<<]>>>>>>[-<<<<<<+>>>>>>]<[<<+>>>+<<[->>>+<-<<]>>>[-<
+<<+>>>]<<<[-]>>[-<<+>>]<<<<<<<<<<[->>>>>>>>>>>+<+<<<<<<<<<<]>>>>>>>>>>>[
+-<<<<<<<<<<<+>>>>>>>>>>>]<[<<<<<<[-]>>>>>>[-]]<[-]]<<<<<<<<<[->>>>>>>>>>
++<+<<<<<<<<<]>>>>>>>>>>[-<<<<<<<<<<+>>>>>>>>>>]<<[->>+<+<]>>[-<<+>>]<[->
+>+<+<]>>[-<<+>>]<[<<<<++>>>-[->>>+<+<<]>>>[-<<<+>>>]<[<<<<<<++>>>>>>[-]]
+<<[-]>[-]]<<[-]<<<<[-]>[->>>>>+<+<<<<]>>>>>[-<<<<<+>>>>>]+++<[->-<<+>>>+
+<[->>>+<+<<]>>>[-<<<+>>>]<[<[-]>[-]]<[<+++<<[-]<<<<+>>>>>>>[-]]<<]>[-]<<
+<<<<[-]>[-]>>>[-<<<+>>>]<<[->>>>+<+<<<]>>>>[-<<<<+>>>>]+++<[->-<<+>>>+<[
+->>>+<+<<]>>>[-<<<+>>>]<[<[-]>[-]]<[<+++<<[-]<<<<+>>>>>>>[-]]<<]>[-]<<<<
+<<[-]>>[-]>>[-<<+>>]<[->+<<<<+>>>]>[-<+>]<<<<[->>>>>>>+<+<<<<<<]>>>>>>>[
+-<<<<<<<+>>>>>>>]++++++++++<[->-<<+>>>+<[->>>+<+<<]>>>[-<<<+>>>]<[<[-]>[
+-]]<[<++++++++++<<[-]<+>>>>[-]]<<]>[-]<<<<<<<[-]>>>>[->>>>+<+<<<]>>>>[-<
+<<<+>>>>]++++++++++<[->-<<+>>>+<[->>>+<+<<]>>>[-<<<+>>>]<[<[-]>[-]]<[<++
+++++++++<<[-]<<<<<<+>>>>>>>>>[-]]<<]>[-]<<<<[-]<<<<[-]>>>>>>[->+<<<+>>]>
+[-<+>]<<<[<<<<[-]+>>>>[-]]<<<<[->>>>>>>+<<<+<<<<]>>>>>>>[-<<<<<<<+>>>>>>
+>]<<<[>>>++++++[-<++++++++>]<.<<[-]]>>[-]<<<<<<[-]+>>>>>[->+<<+>]>[-<+>]
+<<[<<<<[-]+>>>>[-]]<<<<[->>>>>>+<<+<<<<]>>>>>>[-<<<<<<+>>>>>>]<<[>>+++++
++[-<++++++++>]<.<[-]]>[-]<<<<<[-]>>>>+++++[-<<<<++++++>>>>]<<<<++.[-]+++
++++++[->++++++++<]>+.>>>+++++[-<<<<++++++>>>>]<<<<++.[-]++++++++[->>++++
+++++<<]>>+.<<++++++++++.[-]>[-]>[-]>[-]<<<<[-]]<]
@@ -0,0 +1,25 @@
+>+>+>+>+>++<[>[<+++>-
+
+  >>>>>
+  >+>+>+>+>++<[>[<+++>-
+
+    >>>>>
+    >+>+>+>+>++<[>[<+++>-
+
+      >>>>>
+      >+>+>+>+>++<[>[<+++>-
+
+        >>>>>
+        +++[->+++++<]>[-]<
+        <<<<<
+
+      ]<<]>[-]
+      <<<<<
+
+    ]<<]>[-]
+    <<<<<
+
+  ]<<]>[-]
+  <<<<<
+
+]<<]>.
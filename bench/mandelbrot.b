@@ -0,0 +1,119 @@
+Mandelbrot
+Escape time rendering of the Mandelbrot set as 80 x 32 characters
+Fixed point with 1/64 steps; numbers are kept as magnitude and sign
+Each point prints a letter for the iteration it escaped at or a hash mark
+when it stays inside for 32 iterations
+Needs 16 bit cells
+
+>[-]>>+++++++[-<<++++++++>>]<<++++++>[-]+>+++++[-<<<++++++>>>]<<<++[->>>
+>[-]>>+++++++++++[-<<+++++++++++>>]<<+++++++>[-]+>++++++++[-<<<+++++++++
++>>>]<<<[->>>>>>>>>>>+++++[-<<<++++++>>>]<<<++>+[>>>>+++++++++++[-<+++++
+++++++>]<+++++++[->>+<+<]>>[-<<+>>]<<<<<<<<<<<[->>>>>>>>>>>>+<+<<<<<<<<<
+<<]>>>>>>>>>>>>[-<<<<<<<<<<<<+>>>>>>>>>>>>]<[->+<<[->>>>+<+<<<]>>>>[-<<<
+<+>>>>]<[<<<->>[-]>[-]]<[<<<<[-]+>>>>[-]]<]<[-]<[-]>+++++++++++[-<++++++
++++++>]<+++++++[->>+<+<]>>[-<<+>>]<<<<<<<<<[->>>>>>>>>>+<+<<<<<<<<<]>>>>
+>>>>>>[-<<<<<<<<<<+>>>>>>>>>>]<[->+<<[->>>>+<+<<<]>>>>[-<<<<+>>>>]<[<<<-
+>>[-]>[-]]<[<<<<[-]+>>>>[-]]<]<[-]<[-]+<[->>>+<+<<]>>>[-<<<+>>>]<[<<<[-]
++<[-]>>>[-]>[-]]<[<<<<<<<<<[->>>>>>>>>>>>>>>+<+<<<<<<<<<<<<<<]>>>>>>>>>>
+>>>>>[-<<<<<<<<<<<<<<<+>>>>>>>>>>>>>>>]<[-<<<<<<<<<<<<<<[->>>>>>>>>>>>>>
+>+<<+<<<<<<<<<<<<<]>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<+>>>>>>>>>>>>>>>]<]<[
+->>>+<+<<]>>>[-<<<+>>>]>++++++++[-<++++++++>]<<[->-<<+>>>+<[->>>+<+<<]>>
+>[-<<<+>>>]<[<[-]>[-]]<[>++++++++[-<<++++++++>>]<<<<[-]<<<+>>>>>>[-]]<<]
+>[-]<<[-]<[-]<<<<<<<<<<<[->>>>>>>>>>>>>+<+<<<<<<<<<<<<]>>>>>>>>>>>>>[-<<
+<<<<<<<<<<<+>>>>>>>>>>>>>]<[-<<<<<<<<<<<<[->>>>>>>>>>>>>+<<+<<<<<<<<<<<]
+>>>>>>>>>>>>>[-<<<<<<<<<<<<<+>>>>>>>>>>>>>]<]<[->>>+<+<<]>>>[-<<<+>>>]>+
++++++++[-<++++++++>]<<[->-<<+>>>+<[->>>+<+<<]>>>[-<<<+>>>]<[<[-]>[-]]<[>
+++++++++[-<<++++++++>>]<<<<[-]<<+>>>>>[-]]<<]>[-]<<[-]<[-]<<[->>>+<+<<]>
+>>[-<<<+>>>]<<[->>+<+<]>>[-<<+>>]>>++++++++++++++++[-<++++++++++++++++>]
+<[->>+<+<]>>[-<<+>>]<<<<[->>>>>+<+<<<<]>>>>>[-<<<<<+>>>>>]<[->+<<[->>>>+
+<+<<<]>>>>[-<<<<+>>>>]<[<<<->>[-]>[-]]<[<<<<[-]+>>>>[-]]<]<[-]<[-]<<[-]+
+>[->>+<+<]>>[-<<+>>]<[<<<<<<<<[-]+<[-]>>>>>>>[-]>>[-]]<<[<<<<<<<<<<<<<[-
+>>>>>>>>>>>>>>>>>>>>+<+<<<<<<<<<<<<<<<<<<<]>>>>>>>>>>>>>>>>>>>>[-<<<<<<<
+<<<<<<<<<<<<<+>>>>>>>>>>>>>>>>>>>>]<[-<<<<<<<<<<<<<<<<<[->>>>>>>>>>>>>>>
+>>>+<<+<<<<<<<<<<<<<<<<]>>>>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<<<+>>>>>>>>>
+>>>>>>>>>]<]<[->>>+<+<<]>>>[-<<<+>>>]>++++++++[-<++++++++>]<<[->-<<+>>>+
+<[->>>+<+<<]>>>[-<<<+>>>]<[<[-]>[-]]<[>++++++++[-<<++++++++>>]<<<<[-]<<<
++>>>>>>[-]]<<]>[-]<<[-]<[-]<<[->>>+<+<<]>>>[-<<<+>>>]<[-<<+>>]+<<<<<<<<<
+<<<<<<<<[->>>>>>>>>>>>>>>>>>>+<+<<<<<<<<<<<<<<<<<<]>>>>>>>>>>>>>>>>>>>[-
+<<<<<<<<<<<<<<<<<<<+>>>>>>>>>>>>>>>>>>>]<[<<+<<<<<<<<<<<<<<[->>>>>>>>>>>
+>>>>>>+<<<-<<<<<<<<<<<<<<]>>>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<<+>>>>>>>>>
+>>>>>>>>]<<[-]>[-]]<[<<<<<<<<<<<<<<<[->>>>>>>>>>>>>>>>>+<<<+<<<<<<<<<<<<
+<<]>>>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<<+>>>>>>>>>>>>>>>>>]<<[-]]<<<<<<<<
+<<<<<<<<[-]>[-]>>>>>>>>>>>>>>>>+<<[->>>>+<+<<<]>>>>[-<<<<+>>>>]<[<<+<<<<
+<<<<<<<<<<<<<<<<<<[->>>>>>>>>>>>>>>>>>>>>>>>>+<<<-<<<<<<<<<<<<<<<<<<<<<<
+]>>>>>>>>>>>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<<<<<<<<<<+>>>>>>>>>>>>>>>>>>
+>>>>>>>]<<[-]>[-]]<[<<<<<<<<<<<<<<<<<<<<<<<[->>>>>>>>>>>>>>>>>>>>>>>>>+<
+<<+<<<<<<<<<<<<<<<<<<<<<<]>>>>>>>>>>>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<<<<
+<<<<<<+>>>>>>>>>>>>>>>>>>>>>>>>>]<<[-]]+<[->>>+<+<<]>>>[-<<<+>>>]<[<<<<[
+->>>>>>>+<+<<<<<<]>>>>>>>[-<<<<<<<+>>>>>>>]<<<<<<<<<<<<<<<<<<<<<<<<<<<<[
+->>>>>>>>>>>>>>>>>>>>>>>>>>>>>+<+<<<<<<<<<<<<<<<<<<<<<<<<<<<<]>>>>>>>>>>
+>>>>>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<<<<<<<<<<<<<<+>>>>>>>>>>>>>>>>>>>>>
+>>>>>>>>]<[->+<<[->>>>+<+<<<]>>>>[-<<<<+>>>>]<[<<<->>[-]>[-]]<[<<<[-]+>>
+>[-]]<]<[-]+<[->>>+<+<<]>>>[-<<<+>>>]<[<<<<<<<<<<<<<<<<<<<<<<<<<<<<[->>>
+>>>>>>>>>>>>>>>>>>>>>>>>>>+<<<<<<<<<<<<<<<<<<<<<<+<<<<<<<]>>>>>>>>>>>>>>
+>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<<<<<<<<<<<<<<+>>>>>>>>>>>>>>>>>>>>>>>>>
+>>>>]<<<<<<<<[->>>>>>>>+<<<<<<<<<<<<<<<<<<<<<<->>>>>>>>>>>>>>]>>>>>>>>[-
+<<<<<<<<+>>>>>>>>]<<<<<<<<<<<<<<<<<<<<<<<<<<<<[->>>>>>>>>>>>>>>>>>>>>>>>
+>>>>+<<<<<<<<<<<<<<<<<<<<<+<<<<<<<]>>>>>>>>>>>>>>>>>>>>>>>>>>>>[-<<<<<<<
+<<<<<<<<<<<<<<<<<<<<<+>>>>>>>>>>>>>>>>>>>>>>>>>>>>]<<[-]>[-]]<[<<<<<<[->
+>>>>>>>+<<<<<<<<<<<<<<<<<<<<<<+>>>>>>>>>>>>>>]>>>>>>>>[-<<<<<<<<+>>>>>>>
+>]<<<<<<<<<<<<<<<<<<<<<<<<<<<<<[->>>>>>>>>>>>>>>>>>>>>>>>>>>>>+<<<<<<<<<
+<<<<<<<<<<<<<-<<<<<<<]>>>>>>>>>>>>>>>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<<<<
+<<<<<<<<<<+>>>>>>>>>>>>>>>>>>>>>>>>>>>>>]<<<<<<<[->>>>>>>+<<<<<<<<<<<<<<
+<<<<<<<+>>>>>>>>>>>>>>]>>>>>>>[-<<<<<<<+>>>>>>>]<<[-]]<[-]<<[-]>[-]]<[<<
+<[->>>>>+<<<<<<<<<<<<<<<<<<<+>>>>>>>>>>>>>>]>>>>>[-<<<<<+>>>>>]<<<<<<<<<
+<<<<<<<<<<<<<<<<<[->>>>>>>>>>>>>>>>>>>>>>>>>>+<<<<<<<<<<<<<<<<<<<+<<<<<<
+<]>>>>>>>>>>>>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<<<<<<<<<<<+>>>>>>>>>>>>>>>
+>>>>>>>>>>>]<<<<[->>>>+<<<<<<<<<<<<<<<<<<+>>>>>>>>>>>>>>]>>>>[-<<<<+>>>>
+]<<[-]]<[-]<<[-]>[-]<<<<<<[->>>>>>>>>>>+<+<<<<<<<<<<]>>>>>>>>>>>[-<<<<<<
+<<<<<+>>>>>>>>>>>]<<<<<<<<<<[->>>>>>>>>>>+<+<<<<<<<<<<]>>>>>>>>>>>[-<<<<
+<<<<<<<+>>>>>>>>>>>]<[->+<<[->>>>+<+<<<]>>>>[-<<<<+>>>>]<[<<<->>[-]>[-]]
+<[<<<[-]+>>>[-]]<]<[-]+<[->>>+<+<<]>>>[-<<<+>>>]<[<<<<<<<<<<[->>>>>>>>>>
+>+<<<<<+<<<<<<]>>>>>>>>>>>[-<<<<<<<<<<<+>>>>>>>>>>>]<<<<<<<<<<<<[->>>>>>
+>>>>>>+<<<<<-<<<<<<<]>>>>>>>>>>>>[-<<<<<<<<<<<<+>>>>>>>>>>>>]<<<<+>>[-]>
+[-]]<[<<<<<<<<<<[->>>>>>>>>>>>+<<<<<+<<<<<<<]>>>>>>>>>>>>[-<<<<<<<<<<<<+
+>>>>>>>>>>>>]<<<<<<<<<<<[->>>>>>>>>>>+<<<<<-<<<<<<]>>>>>>>>>>>[-<<<<<<<<
+<<<+>>>>>>>>>>>]<<[-]]<[-]<<<<<<<<<<<<<<<<<<<<[-]>[-]>>>>>>>>>>>>>>>>>>>
+>+<<[->>>>+<+<<<]>>>>[-<<<<+>>>>]<[<<+<<<<<<<<<<<<<<<<<<<<<[->>>>>>>>>>>
+>>>>>>>>>>>>>+<<<-<<<<<<<<<<<<<<<<<<<<<]>>>>>>>>>>>>>>>>>>>>>>>>[-<<<<<<
+<<<<<<<<<<<<<<<<<<+>>>>>>>>>>>>>>>>>>>>>>>>]<<[-]>[-]]<[<<<<<<<<<<<<<<<<
+<<<<<<[->>>>>>>>>>>>>>>>>>>>>>>>+<<<+<<<<<<<<<<<<<<<<<<<<<]>>>>>>>>>>>>>
+>>>>>>>>>>>[-<<<<<<<<<<<<<<<<<<<<<<<<+>>>>>>>>>>>>>>>>>>>>>>>>]<<[-]]+<[
+->>>+<+<<]>>>[-<<<+>>>]<[<<<<[->>>>>>>+<+<<<<<<]>>>>>>>[-<<<<<<<+>>>>>>>
+]<<<<<<<<<<<<<<<<<<<<<<<<<<<[->>>>>>>>>>>>>>>>>>>>>>>>>>>>+<+<<<<<<<<<<<
+<<<<<<<<<<<<<<<<]>>>>>>>>>>>>>>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<<<<<<<<<<
+<<<+>>>>>>>>>>>>>>>>>>>>>>>>>>>>]<[->+<<[->>>>+<+<<<]>>>>[-<<<<+>>>>]<[<
+<<->>[-]>[-]]<[<<<[-]+>>>[-]]<]<[-]+<[->>>+<+<<]>>>[-<<<+>>>]<[<<<<<<<<<
+<<<<<<<<<<<<<<<<<<[->>>>>>>>>>>>>>>>>>>>>>>>>>>>+<<<<<<<<<<<<<<<<<<<<<<<
+<<<+<<]>>>>>>>>>>>>>>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<<<<<<<<<<<<<+>>>>>>
+>>>>>>>>>>>>>>>>>>>>>>]<<<<<<<<[->>>>>>>>+<<<<<<<<<<<<<<<<<<<<<<<<<<->>>
+>>>>>>>>>>>>>>>]>>>>>>>>[-<<<<<<<<+>>>>>>>>]<<<<<<<<<<<<<<<<<<<<<<<<<<<[
+->>>>>>>>>>>>>>>>>>>>>>>>>>>+<<<<<<<<<<<<<<<<<<<<<<<<<+<<]>>>>>>>>>>>>>>
+>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<<<<<<<<<<<<+>>>>>>>>>>>>>>>>>>>>>>>>>>>]<
+<[-]>[-]]<[<<<<<<[->>>>>>>>+<<<<<<<<<<<<<<<<<<<<<<<<<<+>>>>>>>>>>>>>>>>>
+>]>>>>>>>>[-<<<<<<<<+>>>>>>>>]<<<<<<<<<<<<<<<<<<<<<<<<<<<<[->>>>>>>>>>>>
+>>>>>>>>>>>>>>>>+<<<<<<<<<<<<<<<<<<<<<<<<<<-<<]>>>>>>>>>>>>>>>>>>>>>>>>>
+>>>[-<<<<<<<<<<<<<<<<<<<<<<<<<<<<+>>>>>>>>>>>>>>>>>>>>>>>>>>>>]<<<<<<<[-
+>>>>>>>+<<<<<<<<<<<<<<<<<<<<<<<<<+>>>>>>>>>>>>>>>>>>]>>>>>>>[-<<<<<<<+>>
+>>>>>]<<[-]]<[-]<<[-]>[-]]<[<<<[->>>>>+<<<<<<<<<<<<<<<<<<<<<<<+>>>>>>>>>
+>>>>>>>>>]>>>>>[-<<<<<+>>>>>]<<<<<<<<<<<<<<<<<<<<<<<<<[->>>>>>>>>>>>>>>>
+>>>>>>>>>+<<<<<<<<<<<<<<<<<<<<<<<+<<]>>>>>>>>>>>>>>>>>>>>>>>>>[-<<<<<<<<
+<<<<<<<<<<<<<<<<<+>>>>>>>>>>>>>>>>>>>>>>>>>]<<<<[->>>>+<<<<<<<<<<<<<<<<<
+<<<<<+>>>>>>>>>>>>>>>>>>]>>>>[-<<<<+>>>>]<<[-]]<[-]<<[-]>[-]<<<<<<<<<<<<
+<<<+>->>>>>>>>>>>+<<<<<<<<<<<[->>>>>>>>>>>>>+<+<<<<<<<<<<<<]>>>>>>>>>>>>
+>[-<<<<<<<<<<<<<+>>>>>>>>>>>>>]<[<[-]>[-]]<[<<<<<<<<<<[-]>>>>>>>>>>[-]]<
+<<[-]]>[-]<<<[-]>[-]<<<[-]]<[-]<<]>>+<[->>>+<+<<]>>>[-<<<+>>>]<[>>++++++
+++[-<++++++++>]<+<<<<<<[->>>>>>>+<+<<<<<<]>>>>>>>[-<<<<<<<+>>>>>>>]<.[-]
+<<[-]>[-]]<[>>>+++++[-<+++++++>]<.[-]<<[-]]<<<<[-]>[-]>>[-]<<<<<<<[-]>[-
+]>[-]>[-]<<<+<[->>>+<+<<]>>>[-<<<+>>>]<[>>+++<<<<<[->>>>>>>+<+<<<<<<]>>>
+>>>>[-<<<<<<<+>>>>>>>]<<[->>>+<+<<]>>>[-<<<+>>>]<[->+<<[->>>>+<+<<<]>>>>
+[-<<<<+>>>>]<[<<<->>[-]>[-]]<[<<<<[-]+>>>>[-]]<]<[-]<[-]+<[->>>+<+<<]>>>
+[-<<<+>>>]<[>++<<<<<<<[->>>>>>>>+<-<<<<<<<]>>>>>>>>[-<<<<<<<<+>>>>>>>>]<
+<<<<<<<[-]>>>>>>>[-<<<<<<<+>>>>>>>]<<<<<<[-]>>>>[-]>[-]]<[<<<<<-->>>>>[-
+]]<[-]<<[-]>[-]]<[<<++>>[-]]<<<]>>>++++++++++.[-]<<[-]>[-]<<+<[->>>+<+<<
+]>>>[-<<<+>>>]<[>>+++++<<<<<[->>>>>>>+<+<<<<<<]>>>>>>>[-<<<<<<<+>>>>>>>]
+<<[->>>+<+<<]>>>[-<<<+>>>]<[->+<<[->>>>+<+<<<]>>>>[-<<<<+>>>>]<[<<<->>[-
+]>[-]]<[<<<<[-]+>>>>[-]]<]<[-]<[-]+<[->>>+<+<<]>>>[-<<<+>>>]<[>++++<<<<<
+<<[->>>>>>>>+<-<<<<<<<]>>>>>>>>[-<<<<<<<<+>>>>>>>>]<<<<<<<<[-]>>>>>>>[-<
+<<<<<<+>>>>>>>]<<<<<<[-]>>>>[-]>[-]]<[<<<<<---->>>>>[-]]<[-]<<[-]>[-]]<[
+<<++++>>[-]]<<<]
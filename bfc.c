@@ -1,287 +1,5741 @@
 /*
  * Brainfuck Compiler
- * Compiles Brainfuck code to x86-64 assembly (AT&T syntax)
+ * Compiles Brainfuck code to x86-64 assembly (AT&T syntax) or directly to
+ * a static ELF executable, or to AArch64 assembly
  * Supports all 8 Brainfuck operations: + - > < . , [ ]
  */
 
+#define _GNU_SOURCE
+
 #include <stdio.h>
+#include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
+#include <limits.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <time.h>
+#include <setjmp.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "bfc.h"
 
 #define MAX_CODE_SIZE 1000000
 #define MEMORY_SIZE 30000
+#define OUTPUT_BUFFER_SIZE 65536
+#define INPUT_BUFFER_SIZE 65536
+#define SCAN_BLOCK 16
+#define PAGE_SIZE 4096
+#define MAX_TAPE_SIZE (1ULL << 40)
+#define ARENA_CHUNK_SIZE (1 << 16)
+#define ARENA_ALIGN 16
+#define PARSE_CHUNK_SIZE (1 << 22)  // smallest source slice given its own thread
+#define MAX_PARSE_CHUNKS 64
+
+// Where fail() returns to while bfc_compile runs on this thread, and what it
+// reports. Without a target the message goes to stderr and the process exits.
+static _Thread_local jmp_buf *fail_target;
+static _Thread_local bfc_status fail_status;
+static _Thread_local char fail_message[512];
+
+// Abort the current compilation with a status and message
+static _Noreturn void fail(bfc_status status, const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    vsnprintf(fail_message, sizeof(fail_message), format, args);
+    va_end(args);
+    
+    if (fail_target) {
+        fail_status = status;
+        longjmp(*fail_target, 1);
+    }
+    fprintf(stderr, "%s\n", fail_message);
+    exit(1);
+}
+
+// Block of arena memory; allocations are carved from data in order
+typedef struct ArenaChunk {
+    struct ArenaChunk *next;
+    size_t size;            // usable bytes in data
+    size_t used;
+    max_align_t data[];
+} ArenaChunk;
+
+// Bump allocator holding everything one compilation allocates: the source
+// text, IR, bracket and label tables, the loop stack and the assembler's
+// buffers. Nothing is freed individually; arena_reset rewinds the whole
+// arena and keeps its chunks for the next compilation.
+typedef struct {
+    ArenaChunk *first;
+    ArenaChunk *current;    // chunk allocations are taken from
+} Arena;
+
+static size_t arena_round(size_t size) {
+    return (size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+}
+
+// Allocate `size` bytes, moving on to a later chunk or a new one when the
+// current chunk is full
+static void *arena_alloc(Arena *arena, size_t size) {
+    size = arena_round(size);
+    for (ArenaChunk *chunk = arena->current; chunk; chunk = chunk->next) {
+        if (chunk->size - chunk->used >= size) {
+            arena->current = chunk;
+            void *p = (char *)chunk->data + chunk->used;
+            chunk->used += size;
+            return p;
+        }
+    }
+    
+    size_t bytes = size > ARENA_CHUNK_SIZE ? size : ARENA_CHUNK_SIZE;
+    ArenaChunk *chunk = malloc(sizeof(ArenaChunk) + bytes);
+    if (!chunk) {
+        fail(BFC_ERR_MEMORY, "Memory allocation failed");
+    }
+    chunk->size = bytes;
+    chunk->used = size;
+    if (arena->current) {
+        chunk->next = arena->current->next;
+        arena->current->next = chunk;
+    } else {
+        chunk->next = NULL;
+        arena->first = chunk;
+    }
+    arena->current = chunk;
+    return chunk->data;
+}
+
+// Resize an allocation of `old_size` bytes. The most recent allocation grows
+// in place while its chunk has room; anything else is copied.
+static void *arena_grow(Arena *arena, void *ptr, size_t old_size, size_t new_size) {
+    ArenaChunk *chunk = arena->current;
+    if (ptr && chunk && (char *)ptr + arena_round(old_size) == (char *)chunk->data + chunk->used) {
+        size_t start = chunk->used - arena_round(old_size);
+        if (chunk->size - start >= arena_round(new_size)) {
+            chunk->used = start + arena_round(new_size);
+            return ptr;
+        }
+    }
+    
+    void *p = arena_alloc(arena, new_size);
+    if (ptr && old_size) {
+        memcpy(p, ptr, old_size < new_size ? old_size : new_size);
+    }
+    return p;
+}
+
+// Drop every allocation at once, keeping the chunks for reuse
+static void arena_reset(Arena *arena) {
+    for (ArenaChunk *chunk = arena->first; chunk; chunk = chunk->next) {
+        chunk->used = 0;
+    }
+    arena->current = arena->first;
+}
+
+// Give the arena's memory back to the system
+static void arena_release(Arena *arena) {
+    ArenaChunk *chunk = arena->first;
+    while (chunk) {
+        ArenaChunk *next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+    arena->first = NULL;
+    arena->current = NULL;
+}
+
+// Bytes allocated since the last reset
+static size_t arena_used(const Arena *arena) {
+    size_t used = 0;
+    for (const ArenaChunk *chunk = arena->first; chunk; chunk = chunk->next) {
+        used += chunk->used;
+    }
+    return used;
+}
+
+// Grow an arena array to hold at least `needed` elements
+static void *grow_array(Arena *arena, void *array, size_t *capacity, size_t needed, size_t element) {
+    if (needed <= *capacity) {
+        return array;
+    }
+    
+    size_t size = *capacity ? *capacity : 64;
+    while (size < needed) size *= 2;
+    if (size > SIZE_MAX / element) {
+        fail(BFC_ERR_MEMORY, "Memory allocation failed");
+    }
+    array = arena_grow(arena, array, *capacity * element, size * element);
+    *capacity = size;
+    return array;
+}
 
 typedef struct {
-    char *code;
+    const char *code;
     size_t length;
     size_t position;
+    bool mapped;        // code is a read-only mapping of the file, not arena memory
+    const char *name;   // file name used in diagnostics
+    int *brackets;      // bracket number -> number of its partner, see match_brackets
+    size_t bracket_count;
 } Source;
 
+// What ',' stores when stdin is exhausted
+typedef enum {
+    EOF_UNCHANGED,  // leave the cell as it was
+    EOF_ZERO,       // store 0
+    EOF_MINUS_ONE   // store -1 (255)
+} EofMode;
+
+// Where the tape lives in the generated program
+typedef enum {
+    TAPE_STATIC,    // zero-filled .bss array
+    TAPE_MMAP       // anonymous mapping between guard pages, paged in on demand
+} TapeMode;
+
+// Architecture of the generated code
+typedef enum {
+    TARGET_X86_64,
+    TARGET_AARCH64      // assembly only, see a64_instruction
+} Target;
+
+// What the compiler writes
+typedef enum {
+    FORMAT_ASM,     // AT&T assembly for as/ld
+    FORMAT_ELF,     // static x86-64 ELF executable
+    FORMAT_JIT,     // encode into memory and run in this process (--run)
+    FORMAT_INTERPRET    // run the optimized IR in the interpreter (--interpret)
+} OutputFormat;
+
+typedef struct {
+    EofMode eof_mode;
+    TapeMode tape_mode;
+    size_t tape_size;       // cells
+    int cell_size;          // bytes per cell: 1, 2 or 4
+    OutputFormat format;
+    Target target;
+    const char *profile;    // loop count file written at exit, NULL for none
+    const char *use_profile;    // loop counts to optimize for, NULL for none
+    bool safe;              // check tape accesses once per block, see plan_checks
+    int opt_level;          // 0-3, see bfc_opt_level
+    bool dump_tape;         // write the cells to stderr at exit
+} Options;
+
+typedef struct Program Program;
+typedef struct Asm Asm;
+
+// Labels of the runtime support code and data, created for every program
+typedef enum {
+    RT_START,
+    RT_MEMORY,
+    RT_OUT_BUF,
+    RT_IN_BUF,
+    RT_PUTCHAR,
+    RT_FLUSH,
+    RT_GETCHAR,
+    RT_WRITE,
+    RT_WRITE_ERROR,
+    RT_SEGV_HANDLER,
+    RT_SIGRETURN,
+    RT_SIGACTION,
+    RT_TAPE_ERROR,
+    RT_PROFILE,
+    RT_PROFILE_DUMP,
+    RT_PRINT_NUMBER,
+    RT_TAPE_BASE,
+    RT_BOUNDS_ERROR,
+    RT_OLD_SIGACTION,
+    RT_HOST_STACK,
+    RT_TAPE_FAULT,
+    RT_RETURN,
+    RT_COUNT
+} RuntimeLabel;
+
+static const char *runtime_names[RT_COUNT] = {
+    "_start", "memory", "out_buf", "in_buf", "bf_putchar", "bf_flush",
+    "bf_getchar", "bf_write", "bf_write_error", "bf_segv_handler",
+    "bf_sigreturn", "bf_sigaction", "bf_tape_error", "bf_profile_counts",
+    "bf_profile_dump", "bf_print_number", "bf_tape_base", "bf_bounds_error",
+    "bf_old_sigaction", "bf_host_stack", "bf_tape_fault", "bf_return"
+};
+
+// Registers that hold cells inside innermost loops; none of them is used by
+// the runtime routines or clobbered by a system call
+#define CELL_REGS 4
+
+// Constant string referenced by an OP_PRINT, emitted after the code
+typedef struct {
+    int label;
+    int start;              // offset in the program's data pool
+    int length;
+} PendingString;
+
+// A loop counted by --profile, with the position of its '[' in the source.
+// The counts are only gathered here by the interpreter; generated code keeps
+// them in bf_profile_counts.
+typedef struct {
+    int label;              // number of its loop_start label
+    int line;
+    int column;
+    uint64_t entries;       // times the '[' was reached
+    uint64_t iterations;    // times the body was run
+} ProfileLoop;
+
+// Bounds check emitted by --safe where a block of straight-line code
+// starts: the cells low..high around the data pointer must be on the tape
+typedef struct {
+    bool needed;            // false when earlier checks already cover it
+    bool hoisted;           // loop body checked once on entry, not per iteration
+    long long low;
+    long long high;
+    int bracket;            // bracket that opens the block, -1 at program start
+    int label;              // its bf_bounds_error stub once emitted
+} BoundsCheck;
+
+// How to emit a loop, decided from a recorded profile
+typedef struct {
+    bool align;             // start the loop on a LOOP_ALIGN boundary
+    int unroll;             // copies of the body, 0 or 1 for none
+} LoopPlan;
+
 typedef struct {
-    FILE *output;
+    Arena arena;            // everything allocated for the current program
+    bfc_sink *sink;         // receives the output; unused when running in-process
+    Options options;
+    Program *program;       // IR being emitted
+    Asm *as;                // text or binary assembler for the output
+    int runtime[RT_COUNT];  // runtime label ids in as
+    int *jump_labels;       // loop_start label of each OP_JZ, by IR index
+    PendingString *strings;
+    size_t string_count;
+    size_t string_capacity;
     int label_counter;
     int *loop_stack;
     int loop_stack_top;
-    int loop_stack_size;
+    size_t loop_stack_size;
+    ProfileLoop *profile;   // loops in IR order when profiling
+    size_t profile_count;
+    size_t profile_next;    // next loop to be emitted
+    LoopPlan *plans;        // by IR index with --use-profile, else NULL
+    int cell_regs[CELL_REGS];   // cell offsets held in cell_registers[]
+    int cell_reg_count;     // nonzero inside an innermost loop only
+    bfc_stats *stats;       // phases are recorded here when not NULL
+    const Source *source;   // program being compiled, for diagnostics
+    BoundsCheck *checks;    // by IR index of the block's first operation with --safe
+    void *mapping;          // memory of the program running in this process
+    size_t mapping_size;
 } Compiler;
 
-// Error handling
-void error(const char *msg, int pos) {
-    fprintf(stderr, "Error at position %d: %s\n", pos, msg);
-    exit(1);
+// Unmap the memory of the program run in this process; fail() leaves it
+// for bfc_compile to release
+static void release_mapping(Compiler *c) {
+    if (c->mapping) {
+        munmap(c->mapping, c->mapping_size);
+        c->mapping = NULL;
+    }
+}
+
+// Forget the previous program: all per-program state lives in the arena
+static void reset_compiler(Compiler *c) {
+    arena_reset(&c->arena);
+    c->program = NULL;
+    c->as = NULL;
+    c->jump_labels = NULL;
+    c->strings = NULL;
+    c->string_count = 0;
+    c->string_capacity = 0;
+    c->label_counter = 0;
+    c->loop_stack = NULL;
+    c->loop_stack_size = 0;
+    c->loop_stack_top = -1;
+    c->profile = NULL;
+    c->profile_count = 0;
+    c->profile_next = 0;
+    c->plans = NULL;
+    c->cell_reg_count = 0;
+    c->stats = NULL;
+    c->source = NULL;
+    c->checks = NULL;
 }
 
 // Initialize compiler
-Compiler *create_compiler(const char *output_file) {
+static Compiler *create_compiler(const Options *options) {
     Compiler *c = malloc(sizeof(Compiler));
     if (!c) {
-        fprintf(stderr, "Memory allocation failed\n");
-        exit(1);
-    }
-    
-    c->output = fopen(output_file, "w");
-    if (!c->output) {
-        fprintf(stderr, "Could not open output file: %s\n", output_file);
-        exit(1);
+        fail(BFC_ERR_MEMORY, "Memory allocation failed");
     }
     
-    c->label_counter = 0;
-    c->loop_stack_size = 100;
-    c->loop_stack = malloc(sizeof(int) * c->loop_stack_size);
-    c->loop_stack_top = -1;
+    c->options = *options;
+    c->sink = NULL;
+    c->arena.first = NULL;
+    c->arena.current = NULL;
+    c->mapping = NULL;
+    reset_compiler(c);
     
     return c;
 }
 
 // Push loop label to stack
-void push_loop(Compiler *c, int label) {
-    if (c->loop_stack_top >= c->loop_stack_size - 1) {
-        c->loop_stack_size *= 2;
-        c->loop_stack = realloc(c->loop_stack, sizeof(int) * c->loop_stack_size);
-    }
+static void push_loop(Compiler *c, int label) {
+    c->loop_stack = grow_array(&c->arena, c->loop_stack, &c->loop_stack_size,
+                               (size_t)c->loop_stack_top + 2, sizeof(int));
     c->loop_stack[++c->loop_stack_top] = label;
 }
 
 // Pop loop label from stack
-int pop_loop(Compiler *c) {
+static int pop_loop(Compiler *c) {
     if (c->loop_stack_top < 0) {
-        error("Unmatched ']'", 0);
+        fail(BFC_ERR_INTERNAL, "Internal error: unbalanced loop operations");
     }
     return c->loop_stack[c->loop_stack_top--];
 }
 
 // Get next label number
-int next_label(Compiler *c) {
+static int next_label(Compiler *c) {
     return c->label_counter++;
 }
 
-// Emit assembly header
-void emit_header(Compiler *c) {
-    fprintf(c->output, "    .section .data\n");
-    fprintf(c->output, "memory:\n");
-    fprintf(c->output, "    .zero %d\n\n", MEMORY_SIZE);
+// x86-64 registers, numbered as in the instruction encoding. XMM registers
+// use the same numbers.
+typedef enum {
+    RAX, RCX, RDX, RBX, RSP, RBP, RSI, RDI,
+    R8, R9, R10, R11, R12, R13, R14, R15
+} Reg;
+
+// Instructions understood by the assembler. The ALU group values are the
+// opcode extensions of the 0x80/0x81/0x83 immediate forms.
+typedef enum {
+    I_ADD = 0, I_OR = 1, I_AND = 4, I_SUB = 5, I_XOR = 6, I_CMP = 7,
+    I_MOV, I_TEST, I_LEA, I_INC, I_DEC, I_NEG, I_DIV, I_PUSH, I_POP,
+    I_MOVZB, I_MOVZW, I_BSF, I_BSR, I_CMOVA, I_IMUL,
+    I_RET, I_SYSCALL, I_REP_MOVSB,
+    I_PXOR, I_MOVDQU, I_PCMPEQB, I_PCMPEQW, I_PCMPEQD, I_PMOVMSKB,
+    I_COUNT
+} Insn;
+
+// Condition codes for jumps, as encoded in 0x0F 0x80+cc
+typedef enum {
+    CC_B = 0x2, CC_AE = 0x3, CC_E = 0x4, CC_NE = 0x5,
+    CC_BE = 0x6, CC_A = 0x7, CC_L = 0xc, CC_GE = 0xd, CC_LE = 0xe, CC_G = 0xf
+} Cond;
+
+typedef enum {
+    OPD_REG,    // register
+    OPD_IMM,    // immediate value
+    OPD_MEM,    // disp(base) or disp(base,index)
+    OPD_RIP     // label+disp(%rip)
+} OperandKind;
+
+typedef struct {
+    OperandKind kind;
+    int reg;            // register, or base register of OPD_MEM
+    int index;          // index register of OPD_MEM, -1 if none
+    long long value;    // immediate, or displacement
+    int label;          // target of OPD_RIP
+} Operand;
+
+static Operand reg(int r) {
+    return (Operand){ OPD_REG, r, -1, 0, -1 };
+}
+
+static Operand imm(long long value) {
+    return (Operand){ OPD_IMM, 0, -1, value, -1 };
+}
+
+static Operand mem(int base, long long disp) {
+    return (Operand){ OPD_MEM, base, -1, disp, -1 };
+}
+
+static Operand mem_index(int base, int index, long long disp) {
+    return (Operand){ OPD_MEM, base, index, disp, -1 };
+}
+
+static Operand rip(int label, long long disp) {
+    return (Operand){ OPD_RIP, 0, -1, disp, label };
+}
+
+// Output sections; the binary backend lays them out in this order
+typedef enum {
+    SEC_TEXT, SEC_RODATA, SEC_DATA, SEC_BSS, SEC_COUNT
+} SectionId;
+
+// Growable byte buffer: section contents in binary mode, pending output in
+// text mode
+typedef struct {
+    Arena *arena;
+    char *bytes;
+    size_t size;
+    size_t capacity;
+} Buffer;
+
+typedef struct {
+    Buffer data;        // bytes unused for SEC_BSS, only the size counts
+    size_t align;       // largest alignment requested inside the section
+} Section;
+
+typedef struct {
+    const char *name;   // text name is name, or name_number if number >= 0
+    int number;
+    int section;        // -1 until bound
+    size_t offset;
+} Label;
+
+typedef enum {
+    FIX_REL32,          // 32-bit PC-relative field
+    FIX_ABS64           // 64-bit absolute address
+} FixupKind;
+
+typedef struct {
+    FixupKind kind;
+    int section;
+    size_t offset;      // position of the field in its section
+    int label;
+    long long addend;
+} Fixup;
+
+// Text output is collected here and written in blocks of this size
+#define EMIT_BLOCK_SIZE (1 << 20)
+
+// Column where instruction notes start in text mode
+#define NOTE_COLUMN 32
+
+// Assembler: prints AT&T text, or encodes machine code into sections
+struct Asm {
+    Arena *arena;
+    bool binary;
+    bfc_sink *sink;     // where text output is flushed
+    Buffer out;         // pending text output
+    size_t line_start;  // offset in out of the instruction being printed
+    const char *note;   // comment for the next instruction line (text mode)
+    const char *comment;    // starts a note: "#", or "//" for AArch64
+    long long note_count;   // printed as " xN" after the note if >= 0
+    int section;
+    Section sections[SEC_COUNT];
+    Label *labels;
+    size_t label_count;
+    size_t label_capacity;
+    Fixup *fixups;
+    size_t fixup_count;
+    size_t fixup_capacity;
+    char templates[I_COUNT][9][16];     // "    mnemonic<suffix> " by width
+};
+
+static const char *section_names[SEC_COUNT] = {
+    ".text", ".rodata", ".data", ".bss"
+};
+
+static const char *reg_names[4][16] = {
+    { "al", "cl", "dl", "bl", "spl", "bpl", "sil", "dil",
+      "r8b", "r9b", "r10b", "r11b", "r12b", "r13b", "r14b", "r15b" },
+    { "ax", "cx", "dx", "bx", "sp", "bp", "si", "di",
+      "r8w", "r9w", "r10w", "r11w", "r12w", "r13w", "r14w", "r15w" },
+    { "eax", "ecx", "edx", "ebx", "esp", "ebp", "esi", "edi",
+      "r8d", "r9d", "r10d", "r11d", "r12d", "r13d", "r14d", "r15d" },
+    { "rax", "rcx", "rdx", "rbx", "rsp", "rbp", "rsi", "rdi",
+      "r8", "r9", "r10", "r11", "r12", "r13", "r14", "r15" }
+};
+
+static const char *insn_names[I_COUNT] = {
+    [I_ADD] = "add", [I_OR] = "or", [I_AND] = "and", [I_SUB] = "sub",
+    [I_XOR] = "xor", [I_CMP] = "cmp", [I_MOV] = "mov", [I_TEST] = "test",
+    [I_LEA] = "lea", [I_INC] = "inc", [I_DEC] = "dec", [I_NEG] = "neg",
+    [I_DIV] = "div", [I_PUSH] = "push", [I_POP] = "pop",
+    [I_MOVZB] = "movzb", [I_MOVZW] = "movzw", [I_BSF] = "bsf",
+    [I_BSR] = "bsr", [I_CMOVA] = "cmova", [I_IMUL] = "imul", [I_RET] = "ret",
+    [I_SYSCALL] = "syscall", [I_REP_MOVSB] = "rep movsb",
+    [I_PXOR] = "pxor", [I_MOVDQU] = "movdqu", [I_PCMPEQB] = "pcmpeqb",
+    [I_PCMPEQW] = "pcmpeqw", [I_PCMPEQD] = "pcmpeqd", [I_PMOVMSKB] = "pmovmskb"
+};
+
+static const char *cond_names[16] = {
+    [CC_B] = "b", [CC_AE] = "ae", [CC_E] = "e", [CC_NE] = "ne",
+    [CC_BE] = "be", [CC_A] = "a", [CC_L] = "l", [CC_GE] = "ge",
+    [CC_LE] = "le", [CC_G] = "g"
+};
+
+// AT&T operand-size suffix, indexed by width in bytes
+static const char width_suffix[9] = { 0, 'b', 'w', 0, 'l', 0, 0, 0, 'q' };
+
+// Make room for `extra` more bytes and return where they go
+static char *buffer_reserve(Buffer *b, size_t extra) {
+    b->bytes = grow_array(b->arena, b->bytes, &b->capacity, b->size + extra, 1);
+    return b->bytes + b->size;
+}
+
+static void buffer_append(Buffer *b, const void *bytes, size_t count) {
+    memcpy(buffer_reserve(b, count), bytes, count);
+    b->size += count;
+}
+
+static void buffer_char(Buffer *b, char ch) {
+    *buffer_reserve(b, 1) = ch;
+    b->size++;
+}
+
+static void buffer_str(Buffer *b, const char *s) {
+    buffer_append(b, s, strlen(s));
+}
+
+// Decimal integer without going through printf
+static void buffer_int(Buffer *b, long long value) {
+    char digits[24];
+    int n = 0;
+    unsigned long long v = value < 0 ? 0ULL - (unsigned long long)value : (unsigned long long)value;
+    
+    do {
+        digits[n++] = (char)('0' + v % 10);
+        v /= 10;
+    } while (v);
+    if (value < 0) digits[n++] = '-';
     
-    fprintf(c->output, "    .section .text\n");
-    fprintf(c->output, "    .globl _start\n\n");
-    fprintf(c->output, "_start:\n");
-    fprintf(c->output, "    # Initialize data pointer in r12\n");
-    fprintf(c->output, "    leaq memory(%%rip), %%r12\n\n");
+    char *dst = buffer_reserve(b, (size_t)n);
+    for (int i = 0; i < n; i++) {
+        dst[i] = digits[n - 1 - i];
+    }
+    b->size += (size_t)n;
 }
 
-// Emit assembly footer
-void emit_footer(Compiler *c) {
-    fprintf(c->output, "\n    # Exit program\n");
-    fprintf(c->output, "    movq $60, %%rax      # sys_exit\n");
-    fprintf(c->output, "    xorq %%rdi, %%rdi    # exit code 0\n");
-    fprintf(c->output, "    syscall\n");
+// Precompute the "    mnemonic<suffix> " prefix of every instruction and width
+static void build_templates(Asm *a) {
+    static const int widths[] = { 1, 2, 4, 8 };
+    for (int insn = 0; insn < I_COUNT; insn++) {
+        bool movz = insn == I_MOVZB || insn == I_MOVZW;
+        bool bare = insn >= I_RET && insn < I_PXOR;     // no operands
+        for (int w = 0; w < 4; w++) {
+            char suffix[2] = { 0 };
+            if (movz) {
+                suffix[0] = 'l';
+            } else if (insn < I_RET) {
+                suffix[0] = width_suffix[widths[w]];
+            }
+            snprintf(a->templates[insn][widths[w]], sizeof(a->templates[insn][widths[w]]),
+                     "    %s%s%s", insn_names[insn], suffix, bare ? "" : " ");
+        }
+    }
 }
 
-// Compile single instruction
-void compile_instruction(Compiler *c, char instruction) {
-    switch (instruction) {
-        case '+':
-            fprintf(c->output, "    incb (%%r12)         # +\n");
-            break;
-            
-        case '-':
-            fprintf(c->output, "    decb (%%r12)         # -\n");
-            break;
-            
-        case '>':
-            fprintf(c->output, "    incq %%r12           # >\n");
-            break;
-            
-        case '<':
-            fprintf(c->output, "    decq %%r12           # <\n");
-            break;
-            
-        case '.':
-            fprintf(c->output, "    # Output character (.)\n");
-            fprintf(c->output, "    movq $1, %%rax       # sys_write\n");
-            fprintf(c->output, "    movq $1, %%rdi       # stdout\n");
-            fprintf(c->output, "    movq %%r12, %%rsi    # buffer\n");
-            fprintf(c->output, "    movq $1, %%rdx       # length\n");
-            fprintf(c->output, "    syscall\n\n");
+static Asm *create_asm(Arena *arena, bool binary, bfc_sink *sink) {
+    Asm *a = arena_alloc(arena, sizeof(Asm));
+    memset(a, 0, sizeof(Asm));
+    
+    a->arena = arena;
+    a->out.arena = arena;
+    a->binary = binary;
+    a->sink = sink;
+    a->comment = "#";
+    a->section = SEC_TEXT;
+    for (int i = 0; i < SEC_COUNT; i++) {
+        a->sections[i].data.arena = arena;
+        a->sections[i].align = 16;
+    }
+    if (!binary) {
+        build_templates(a);
+        buffer_reserve(&a->out, EMIT_BLOCK_SIZE + 4096);
+    }
+    
+    return a;
+}
+
+// Pass output bytes to the sink
+static void sink_write(bfc_sink *sink, const void *data, size_t size) {
+    if (size && sink->write(sink->context, data, size) != 0) {
+        fail(BFC_ERR_IO, "Could not write output file");
+    }
+}
+
+// Write pending text output
+static void asm_flush(Asm *a) {
+    sink_write(a->sink, a->out.bytes, a->out.size);
+    a->out.size = 0;
+}
+
+// Store a little-endian integer of `size` bytes
+static void put_le(uint8_t *dst, uint64_t value, int size) {
+    for (int i = 0; i < size; i++) {
+        dst[i] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+// Create a label; it is printed as name, or name_number when number >= 0
+static int asm_new_label(Asm *a, const char *name, int number) {
+    a->labels = grow_array(a->arena, a->labels, &a->label_capacity, a->label_count + 1, sizeof(Label));
+    
+    Label *label = &a->labels[a->label_count];
+    label->name = name;
+    label->number = number;
+    label->section = -1;
+    label->offset = 0;
+    return (int)a->label_count++;
+}
+
+// Label name for diagnostics
+static const char *label_name(const Asm *a, int label, char *buf, size_t size) {
+    const Label *l = &a->labels[label];
+    if (l->number < 0) {
+        return l->name;
+    }
+    snprintf(buf, size, "%s_%d", l->name, l->number);
+    return buf;
+}
+
+// Append raw bytes to the current section
+static void asm_bytes(Asm *a, const void *bytes, size_t count) {
+    buffer_append(&a->sections[a->section].data, bytes, count);
+}
+
+static void asm_byte(Asm *a, int byte) {
+    buffer_char(&a->sections[a->section].data, (char)byte);
+}
+
+static void asm_int(Asm *a, long long value, int size) {
+    uint8_t bytes[8];
+    put_le(bytes, (uint64_t)value, size);
+    asm_bytes(a, bytes, (size_t)size);
+}
+
+static void add_fixup(Asm *a, FixupKind kind, int label, long long addend) {
+    a->fixups = grow_array(a->arena, a->fixups, &a->fixup_capacity, a->fixup_count + 1, sizeof(Fixup));
+    Fixup *fix = &a->fixups[a->fixup_count++];
+    fix->kind = kind;
+    fix->section = a->section;
+    fix->offset = a->sections[a->section].data.size;
+    fix->label = label;
+    fix->addend = addend;
+}
+
+// Hand a full block of text output to stdio
+static void text_written(Asm *a) {
+    if (a->out.size >= EMIT_BLOCK_SIZE) {
+        asm_flush(a);
+    }
+}
+
+// Raw text (directives, comments, blank lines); ignored in binary mode
+static void asm_raw(Asm *a, const char *text) {
+    if (a->binary) {
+        return;
+    }
+    buffer_str(&a->out, text);
+    text_written(a);
+}
+
+// Append formatted text
+static void buffer_vprintf(Buffer *b, const char *format, va_list args) {
+    va_list again;
+    va_copy(again, args);
+    char *dst = buffer_reserve(b, 256);
+    int n = vsnprintf(dst, 256, format, args);
+    if (n >= 256) {
+        dst = buffer_reserve(b, (size_t)n + 1);
+        vsnprintf(dst, (size_t)n + 1, format, again);
+    }
+    va_end(again);
+    b->size += (size_t)n;
+}
+
+// Formatted raw text, for the rare lines that need it
+static void asm_text(Asm *a, const char *format, ...) {
+    if (a->binary) {
+        return;
+    }
+    va_list args;
+    va_start(args, format);
+    buffer_vprintf(&a->out, format, args);
+    va_end(args);
+    text_written(a);
+}
+
+// Attach a comment to the next instruction printed in text mode
+static void asm_note(Asm *a, const char *note) {
+    a->note = note;
+    a->note_count = -1;
+}
+
+// Same, followed by " x<count>"
+static void asm_note_count(Asm *a, const char *note, long long count) {
+    a->note = note;
+    a->note_count = count;
+}
+
+// Start an instruction line with a precomputed mnemonic template
+static void text_begin(Asm *a, const char *template) {
+    a->line_start = a->out.size;
+    buffer_str(&a->out, template);
+}
+
+static void text_label(Asm *a, int label) {
+    const Label *l = &a->labels[label];
+    buffer_str(&a->out, l->name);
+    if (l->number >= 0) {
+        buffer_char(&a->out, '_');
+        buffer_int(&a->out, l->number);
+    }
+}
+
+static void text_reg(Asm *a, const char *name) {
+    buffer_char(&a->out, '%');
+    buffer_str(&a->out, name);
+}
+
+// Print an operand in AT&T syntax; width selects the register name
+static void text_operand(Asm *a, Operand o, int width, bool xmm) {
+    static const int width_index[9] = { 0, 0, 1, 0, 2, 0, 0, 0, 3 };
+    Buffer *out = &a->out;
+    
+    switch (o.kind) {
+        case OPD_REG:
+            if (xmm) {
+                buffer_str(out, "%xmm");
+                buffer_int(out, o.reg);
+            } else {
+                text_reg(a, reg_names[width_index[width]][o.reg]);
+            }
             break;
-            
-        case ',':
-            fprintf(c->output, "    # Input character (,)\n");
-            fprintf(c->output, "    movq $0, %%rax       # sys_read\n");
-            fprintf(c->output, "    movq $0, %%rdi       # stdin\n");
-            fprintf(c->output, "    movq %%r12, %%rsi    # buffer\n");
-            fprintf(c->output, "    movq $1, %%rdx       # length\n");
-            fprintf(c->output, "    syscall\n\n");
+        case OPD_IMM:
+            buffer_char(out, '$');
+            buffer_int(out, o.value);
             break;
-            
-        case '[': {
-            int label = next_label(c);
-            push_loop(c, label);
-            fprintf(c->output, "loop_start_%d:           # [\n", label);
-            fprintf(c->output, "    cmpb $0, (%%r12)\n");
-            fprintf(c->output, "    je loop_end_%d\n\n", label);
+        case OPD_MEM:
+            if (o.value != 0) buffer_int(out, o.value);
+            buffer_char(out, '(');
+            text_reg(a, reg_names[3][o.reg]);
+            if (o.index >= 0) {
+                buffer_char(out, ',');
+                text_reg(a, reg_names[3][o.index]);
+            }
+            buffer_char(out, ')');
             break;
-        }
-            
-        case ']': {
-            int label = pop_loop(c);
-            fprintf(c->output, "    cmpb $0, (%%r12)\n");
-            fprintf(c->output, "    jne loop_start_%d    # ]\n", label);
-            fprintf(c->output, "loop_end_%d:\n\n", label);
+        case OPD_RIP:
+            text_label(a, o.label);
+            if (o.value > 0) buffer_char(out, '+');
+            if (o.value != 0) buffer_int(out, o.value);
+            buffer_str(out, "(%rip)");
             break;
+    }
+}
+
+static void text_separator(Asm *a) {
+    buffer_append(&a->out, ", ", 2);
+}
+
+// Finish an instruction line with the pending note, if any
+static void text_end(Asm *a) {
+    Buffer *out = &a->out;
+    if (a->note) {
+        size_t length = out->size - a->line_start;
+        size_t pad = length < NOTE_COLUMN ? NOTE_COLUMN - length : 0;
+        memset(buffer_reserve(out, pad), ' ', pad);
+        out->size += pad;
+        buffer_char(out, ' ');
+        buffer_str(out, a->comment);
+        buffer_char(out, ' ');
+        buffer_str(out, a->note);
+        if (a->note_count >= 0) {
+            buffer_append(out, " x", 2);
+            buffer_int(out, a->note_count);
         }
+        a->note = NULL;
     }
+    buffer_char(out, '\n');
+    text_written(a);
 }
 
-// Optimize repeated instructions
-int count_repeats(Source *src, char instruction) {
-    int count = 0;
-    size_t pos = src->position;
-    while (pos < src->length && src->code[pos] == instruction) {
-        count++;
-        pos++;
+static void asm_section(Asm *a, int section) {
+    a->section = section;
+    if (!a->binary) {
+        buffer_str(&a->out, "\n    .section ");
+        buffer_str(&a->out, section_names[section]);
+        buffer_char(&a->out, '\n');
     }
-    return count;
 }
 
-// Compile optimized instruction
-void compile_optimized(Compiler *c, Source *src, char instruction) {
-    int count = count_repeats(src, instruction);
-    
-    if (count > 1 && (instruction == '+' || instruction == '-' || 
-                      instruction == '>' || instruction == '<')) {
-        switch (instruction) {
-            case '+':
-                fprintf(c->output, "    addb $%d, (%%r12)    # + x%d\n", count, count);
-                break;
-            case '-':
-                fprintf(c->output, "    subb $%d, (%%r12)    # - x%d\n", count, count);
-                break;
-            case '>':
-                fprintf(c->output, "    addq $%d, %%r12      # > x%d\n", count, count);
-                break;
-            case '<':
-                fprintf(c->output, "    subq $%d, %%r12      # < x%d\n", count, count);
-                break;
-        }
-        src->position += count - 1;
-    } else {
-        compile_instruction(c, instruction);
+// Define a label at the current position
+static void asm_bind(Asm *a, int label) {
+    a->labels[label].section = a->section;
+    a->labels[label].offset = a->sections[a->section].data.size;
+    if (!a->binary) {
+        text_label(a, label);
+        buffer_append(&a->out, ":\n", 2);
     }
 }
 
-// Main compilation function
-void compile(Compiler *c, Source *src) {
-    emit_header(c);
+// Pad the current section to a multiple of `align` bytes (a power of two)
+static void asm_align(Asm *a, size_t align) {
+    Section *sec = &a->sections[a->section];
+    if (align > sec->align) {
+        sec->align = align;
+    }
+    if (!a->binary) {
+        int shift = 0;
+        while (((size_t)1 << shift) < align) shift++;
+        buffer_str(&a->out, "    .p2align ");
+        buffer_int(&a->out, shift);
+        buffer_char(&a->out, '\n');
+        return;
+    }
     
-    while (src->position < src->length) {
-        char ch = src->code[src->position];
-        
-        // Only compile valid Brainfuck instructions
-        if (strchr("+-><.,[]", ch)) {
-            compile_optimized(c, src, ch);
+    // Code padding may be executed, so it is made of as few NOPs as possible
+    static const uint8_t nops[9][9] = {
+        { 0x90 },
+        { 0x66, 0x90 },
+        { 0x0f, 0x1f, 0x00 },
+        { 0x0f, 0x1f, 0x40, 0x00 },
+        { 0x0f, 0x1f, 0x44, 0x00, 0x00 },
+        { 0x66, 0x0f, 0x1f, 0x44, 0x00, 0x00 },
+        { 0x0f, 0x1f, 0x80, 0x00, 0x00, 0x00, 0x00 },
+        { 0x0f, 0x1f, 0x84, 0x00, 0x00, 0x00, 0x00, 0x00 },
+        { 0x66, 0x0f, 0x1f, 0x84, 0x00, 0x00, 0x00, 0x00, 0x00 }
+    };
+    while (sec->data.size % align != 0) {
+        size_t pad = align - sec->data.size % align;
+        if (a->section == SEC_BSS) {
+            sec->data.size++;
+        } else if (a->section == SEC_TEXT) {
+            pad = pad < 9 ? pad : 9;
+            asm_bytes(a, nops[pad - 1], pad);
+        } else {
+            asm_byte(a, 0);
         }
-        
-        src->position++;
+    }
+}
+
+// Reserve zero-filled space
+static void asm_zero(Asm *a, size_t count) {
+    if (!a->binary) {
+        buffer_str(&a->out, "    .zero ");
+        buffer_int(&a->out, (long long)count);
+        buffer_char(&a->out, '\n');
+        return;
     }
     
-    // Check for unmatched brackets
-    if (c->loop_stack_top >= 0) {
-        error("Unmatched '['", 0);
+    Section *sec = &a->sections[a->section];
+    if (a->section != SEC_BSS) {
+        memset(buffer_reserve(&sec->data, count), 0, count);
+    }
+    sec->data.size += count;
+}
+
+// Constant byte string
+static void asm_ascii(Asm *a, const char *bytes, size_t count) {
+    if (a->binary) {
+        asm_bytes(a, bytes, count);
+        return;
     }
     
-    emit_footer(c);
+    Buffer *out = &a->out;
+    buffer_str(out, "    .ascii \"");
+    for (size_t i = 0; i < count; i++) {
+        unsigned char ch = (unsigned char)bytes[i];
+        if (ch >= 32 && ch < 127 && ch != '"' && ch != '\\') {
+            buffer_char(out, (char)ch);
+        } else {
+            char *dst = buffer_reserve(out, 4);
+            dst[0] = '\\';
+            dst[1] = (char)('0' + (ch >> 6));
+            dst[2] = (char)('0' + ((ch >> 3) & 7));
+            dst[3] = (char)('0' + (ch & 7));
+            out->size += 4;
+        }
+    }
+    buffer_append(out, "\"\n", 2);
+    text_written(a);
 }
 
-// Read source file
-Source *read_source(const char *filename) {
-    FILE *f = fopen(filename, "r");
-    if (!f) {
-        fprintf(stderr, "Could not open file: %s\n", filename);
-        exit(1);
+// 64-bit data word holding a constant or the address of a label
+static void asm_quad(Asm *a, long long value) {
+    if (!a->binary) {
+        text_begin(a, "    .quad ");
+        buffer_int(&a->out, value);
+        text_end(a);
+    } else {
+        asm_int(a, value, 8);
+    }
+}
+
+static void asm_quad_label(Asm *a, int label) {
+    if (!a->binary) {
+        text_begin(a, "    .quad ");
+        text_label(a, label);
+        text_end(a);
+    } else {
+        add_fixup(a, FIX_ABS64, label, 0);
+        asm_int(a, 0, 8);
     }
+}
+
+static bool fits_int8(long long value) {
+    return value >= -128 && value <= 127;
+}
+
+// Encode prefixes, opcode and ModRM/SIB/displacement for an instruction
+// whose ModRM reg field is `field` and r/m operand is `rm`. imm_bytes is the
+// number of immediate bytes that follow, needed for RIP-relative fixups.
+static void encode(Asm *a, int width, int prefix, int opcode, int field,
+                   Operand rm, bool byte_field, int imm_bytes) {
+    int rex = 0;
     
-    fseek(f, 0, SEEK_END);
-    long size = ftell(f);
-    fseek(f, 0, SEEK_SET);
+    if (width == 2) asm_byte(a, 0x66);
+    if (prefix) asm_byte(a, prefix);
     
-    char *code = malloc(size + 1);
-    if (!code) {
-        fprintf(stderr, "Memory allocation failed\n");
-        exit(1);
+    if (width == 8) rex |= 0x08;
+    if (field & 8) rex |= 0x04;
+    if (rm.kind == OPD_MEM && rm.index >= 0 && (rm.index & 8)) rex |= 0x02;
+    if ((rm.kind == OPD_MEM || rm.kind == OPD_REG) && (rm.reg & 8)) rex |= 0x01;
+    
+    // spl/bpl/sil/dil are only reachable with a REX prefix
+    if (width == 1 && ((byte_field && field >= 4 && field < 8) ||
+                       (rm.kind == OPD_REG && rm.reg >= 4 && rm.reg < 8))) {
+        rex |= 0x40;
     }
+    if (rex) asm_byte(a, 0x40 | rex);
     
-    fread(code, 1, size, f);
-    code[size] = '\0';
-    fclose(f);
+    if (opcode > 0xff) asm_byte(a, opcode >> 8);   // 0x0F escape
+    asm_byte(a, opcode & 0xff);
     
-    Source *src = malloc(sizeof(Source));
-    src->code = code;
-    src->length = size;
-    src->position = 0;
+    int r = (field & 7) << 3;
+    switch (rm.kind) {
+        case OPD_REG:
+            asm_byte(a, 0xc0 | r | (rm.reg & 7));
+            break;
     
-    return src;
-}
-
-// Cleanup
-void free_compiler(Compiler *c) {
-    if (c->output) fclose(c->output);
-    if (c->loop_stack) free(c->loop_stack);
-    free(c);
+        case OPD_RIP:
+            asm_byte(a, 0x05 | r);
+            add_fixup(a, FIX_REL32, rm.label, rm.value - 4 - imm_bytes);
+            asm_int(a, 0, 4);
+            break;
+    
+        case OPD_MEM: {
+            int base = rm.reg & 7;
+            int mod = rm.value == 0 && base != RBP ? 0 : fits_int8(rm.value) ? 1 : 2;
+            if (rm.index >= 0 || base == RSP) {
+                asm_byte(a, (mod << 6) | r | 4);
+                asm_byte(a, ((rm.index >= 0 ? rm.index & 7 : 4) << 3) | base);
+            } else {
+                asm_byte(a, (mod << 6) | r | base);
+            }
+            if (mod == 1) asm_int(a, rm.value, 1);
+            if (mod == 2) asm_int(a, rm.value, 4);
+            break;
+        }
+    
+        case OPD_IMM:
+            break;
+    }
 }
 
-void free_source(Source *src) {
-    if (src->code) free(src->code);
-    free(src);
+// Immediate size of the full-width immediate forms
+static int imm_size(int width) {
+    return width == 1 ? 1 : width == 2 ? 2 : 4;
 }
 
-int main(int argc, char *argv[]) {
-    if (argc < 2) {
-        fprintf(stderr, "Usage: %s <input.bf> [output.s]\n", argv[0]);
-        fprintf(stderr, "Compiles Brainfuck code to x86-64 assembly\n");
-        return 1;
+// Two-operand instruction in AT&T order: insn src, dst
+static void asm_op(Asm *a, Insn insn, int width, Operand src, Operand dst) {
+    if (!a->binary) {
+        bool sse = insn >= I_PXOR;
+        int src_width = insn == I_MOVZB ? 1 : insn == I_MOVZW ? 2 : width;
+        text_begin(a, a->templates[insn][sse ? 4 : width]);
+        text_operand(a, src, src_width, sse);
+        text_separator(a);
+        text_operand(a, dst, width, sse && insn != I_PMOVMSKB);
+        text_end(a);
+        return;
     }
     
-    const char *input_file = argv[1];
-    const char *output_file = argc > 2 ? argv[2] : "output.s";
+    bool wide = width != 1;
+    int opc;
     
-    printf("Brainfuck Compiler\n");
-    printf("Input:  %s\n", input_file);
-    printf("Output: %s\n", output_file);
+    switch (insn) {
+        case I_ADD: case I_OR: case I_AND: case I_SUB: case I_XOR: case I_CMP:
+            if (src.kind == OPD_IMM) {
+                if (width != 1 && fits_int8(src.value)) {
+                    encode(a, width, 0, 0x83, insn, dst, false, 1);
+                    asm_int(a, src.value, 1);
+                } else {
+                    opc = wide ? 0x81 : 0x80;
+                    encode(a, width, 0, opc, insn, dst, false, imm_size(width));
+                    asm_int(a, src.value, imm_size(width));
+                }
+            } else if (src.kind == OPD_REG) {
+                opc = (insn << 3) | wide;
+                encode(a, width, 0, opc, src.reg, dst, true, 0);
+            } else {
+                opc = (insn << 3) | 2 | wide;
+                encode(a, width, 0, opc, dst.reg, src, true, 0);
+            }
+            break;
     
-    Source *src = read_source(input_file);
-    Compiler *compiler = create_compiler(output_file);
+        case I_MOV:
+            if (src.kind == OPD_IMM) {
+                if (width == 8 && dst.kind == OPD_REG &&
+                    (src.value < INT32_MIN || src.value > INT32_MAX)) {
+                    asm_byte(a, 0x48 | (dst.reg >> 3));
+                    asm_byte(a, 0xb8 | (dst.reg & 7));
+                    asm_int(a, src.value, 8);
+                } else {
+                    opc = wide ? 0xc7 : 0xc6;
+                    encode(a, width, 0, opc, 0, dst, false, imm_size(width));
+                    asm_int(a, src.value, imm_size(width));
+                }
+            } else if (src.kind == OPD_REG) {
+                opc = wide ? 0x89 : 0x88;
+                encode(a, width, 0, opc, src.reg, dst, true, 0);
+            } else {
+                opc = wide ? 0x8b : 0x8a;
+                encode(a, width, 0, opc, dst.reg, src, true, 0);
+            }
+            break;
     
-    compile(compiler, src);
+        case I_TEST:
+            if (src.kind == OPD_IMM) {
+                opc = wide ? 0xf7 : 0xf6;
+                encode(a, width, 0, opc, 0, dst, false, imm_size(width));
+                asm_int(a, src.value, imm_size(width));
+            } else {
+                opc = wide ? 0x85 : 0x84;
+                encode(a, width, 0, opc, src.reg, dst, true, 0);
+            }
+            break;
     
-    printf("Compilation successful!\n");
-    printf("\nTo assemble and run:\n");
-    printf("  as %s -o output.o\n", output_file);
-    printf("  ld output.o -o program\n");
-    printf("  ./program\n");
+        case I_LEA:   encode(a, width, 0, 0x8d, dst.reg, src, false, 0); break;
+        case I_MOVZB: encode(a, width, 0, 0x0fb6, dst.reg, src, false, 0); break;
+        case I_MOVZW: encode(a, width, 0, 0x0fb7, dst.reg, src, false, 0); break;
+        case I_BSF:   encode(a, width, 0, 0x0fbc, dst.reg, src, false, 0); break;
+        case I_BSR:   encode(a, width, 0, 0x0fbd, dst.reg, src, false, 0); break;
+        case I_CMOVA: encode(a, width, 0, 0x0f47, dst.reg, src, false, 0); break;
+    
+        // SSE2: the destination register goes in the reg field
+        case I_PXOR:     encode(a, 4, 0x66, 0x0fef, dst.reg, src, false, 0); break;
+        case I_MOVDQU:   encode(a, 4, 0xf3, 0x0f6f, dst.reg, src, false, 0); break;
+        case I_PCMPEQB:  encode(a, 4, 0x66, 0x0f74, dst.reg, src, false, 0); break;
+        case I_PCMPEQW:  encode(a, 4, 0x66, 0x0f75, dst.reg, src, false, 0); break;
+        case I_PCMPEQD:  encode(a, 4, 0x66, 0x0f76, dst.reg, src, false, 0); break;
+        case I_PMOVMSKB: encode(a, 4, 0x66, 0x0fd7, dst.reg, src, false, 0); break;
+    
+        default:
+            fail(BFC_ERR_INTERNAL, "Internal error: bad two-operand instruction %d", insn);
+    }
+}
+
+// imul $value, src, dst
+static void asm_imul(Asm *a, int width, long long value, Operand src, Operand dst) {
+    if (!a->binary) {
+        text_begin(a, a->templates[I_IMUL][width]);
+        text_operand(a, imm(value), width, false);
+        text_separator(a);
+        text_operand(a, src, width, false);
+        text_separator(a);
+        text_operand(a, dst, width, false);
+        text_end(a);
+        return;
+    }
+    
+    if (fits_int8(value)) {
+        encode(a, width, 0, 0x6b, dst.reg, src, false, 1);
+        asm_int(a, value, 1);
+    } else {
+        encode(a, width, 0, 0x69, dst.reg, src, false, imm_size(width));
+        asm_int(a, value, imm_size(width));
+    }
+}
+
+// One-operand instruction
+static void asm_op1(Asm *a, Insn insn, int width, Operand dst) {
+    if (!a->binary) {
+        text_begin(a, a->templates[insn][width]);
+        text_operand(a, dst, width, false);
+        text_end(a);
+        return;
+    }
+    
+    int group = width == 1 ? 0xf6 : 0xf7;
+    switch (insn) {
+        case I_INC: encode(a, width, 0, width == 1 ? 0xfe : 0xff, 0, dst, false, 0); break;
+        case I_DEC: encode(a, width, 0, width == 1 ? 0xfe : 0xff, 1, dst, false, 0); break;
+        case I_NEG: encode(a, width, 0, group, 3, dst, false, 0); break;
+        case I_DIV: encode(a, width, 0, group, 6, dst, false, 0); break;
+        case I_PUSH:
+        case I_POP:
+            if (dst.reg & 8) asm_byte(a, 0x41);
+            asm_byte(a, (insn == I_PUSH ? 0x50 : 0x58) | (dst.reg & 7));
+            break;
+        default:
+            fail(BFC_ERR_INTERNAL, "Internal error: bad one-operand instruction %d", insn);
+    }
+}
+
+// Instruction without operands
+static void asm_op0(Asm *a, Insn insn) {
+    if (!a->binary) {
+        text_begin(a, a->templates[insn][8]);
+        text_end(a);
+        return;
+    }
+    
+    switch (insn) {
+        case I_RET:       asm_byte(a, 0xc3); break;
+        case I_SYSCALL:   asm_bytes(a, "\x0f\x05", 2); break;
+        case I_REP_MOVSB: asm_bytes(a, "\xf3\xa4", 2); break;
+        default:
+            fail(BFC_ERR_INTERNAL, "Internal error: bad instruction %d", insn);
+    }
+}
+
+// Branch to a label: jmp, call, or jcc (cond >= 0). Backward branches to a
+// nearby label use the short form; everything else uses rel32.
+static void asm_branch(Asm *a, const char *mnemonic, int opcode, int cond, int label) {
+    if (!a->binary) {
+        text_begin(a, "    ");
+        buffer_str(&a->out, mnemonic);
+        if (cond >= 0) buffer_str(&a->out, cond_names[cond]);
+        buffer_char(&a->out, ' ');
+        text_label(a, label);
+        text_end(a);
+        return;
+    }
+    
+    const Label *target = &a->labels[label];
+    const Section *sec = &a->sections[a->section];
+    if (opcode != 0xe8 && target->section == a->section) {
+        long long distance = (long long)target->offset - (long long)(sec->data.size + 2);
+        if (fits_int8(distance)) {
+            asm_byte(a, cond >= 0 ? 0x70 | cond : 0xeb);
+            asm_int(a, distance, 1);
+            return;
+        }
+    }
+    
+    if (cond >= 0) {
+        asm_byte(a, 0x0f);
+        asm_byte(a, 0x80 | cond);
+    } else {
+        asm_byte(a, opcode);
+    }
+    add_fixup(a, FIX_REL32, label, -4);
+    asm_int(a, 0, 4);
+}
+
+static void asm_jmp(Asm *a, int label) {
+    asm_branch(a, "jmp", 0xe9, -1, label);
+}
+
+static void asm_call(Asm *a, int label) {
+    asm_branch(a, "call", 0xe8, -1, label);
+}
+
+static void asm_jcc(Asm *a, Cond cond, int label) {
+    asm_branch(a, "j", 0, cond, label);
+}
+
+// Round up to a multiple of a power of two
+static uint64_t align_up(uint64_t value, uint64_t align) {
+    return (value + align - 1) & ~(align - 1);
+}
+
+// Virtual address of the generated executable's first page
+#define ELF_BASE 0x400000
+#define ELF_HEADER_SIZE (64 + 3 * 56)
+
+// Resolve fixups against the section addresses in addr[]
+static void asm_link(Asm *a, const uint64_t addr[SEC_COUNT]) {
+    for (size_t i = 0; i < a->fixup_count; i++) {
+        const Fixup *fix = &a->fixups[i];
+        const Label *target = &a->labels[fix->label];
+        if (target->section < 0) {
+            char buf[64];
+            fail(BFC_ERR_INTERNAL, "Internal error: undefined label %s",
+                 label_name(a, fix->label, buf, sizeof(buf)));
+        }
+    
+        uint64_t value = addr[target->section] + target->offset + (uint64_t)fix->addend;
+        if (fix->kind == FIX_REL32) {
+            value -= addr[fix->section] + fix->offset;
+            if ((int64_t)value < INT32_MIN || (int64_t)value > INT32_MAX) {
+                fail(BFC_ERR_LIMIT, "Program too large: reference out of 32-bit range");
+            }
+            put_le((uint8_t *)a->sections[fix->section].data.bytes + fix->offset, value, 4);
+        } else {
+            put_le((uint8_t *)a->sections[fix->section].data.bytes + fix->offset, value, 8);
+        }
+    }
+}
+
+// Write the encoded sections as a static ELF executable entering at `entry`.
+// Segment 1 (R+X) holds the headers, text and rodata, segment 2 (R+W) data
+// and bss; no section headers are written.
+static void asm_write_elf(Asm *a, bfc_sink *out, int entry) {
+    const Section *sec = a->sections;
+    uint64_t offset[SEC_COUNT];
+    uint64_t addr[SEC_COUNT];
+    
+    offset[SEC_TEXT] = align_up(ELF_HEADER_SIZE, sec[SEC_TEXT].align);
+    offset[SEC_RODATA] = align_up(offset[SEC_TEXT] + sec[SEC_TEXT].data.size, sec[SEC_RODATA].align);
+    uint64_t code_end = offset[SEC_RODATA] + sec[SEC_RODATA].data.size;
+    offset[SEC_DATA] = align_up(code_end, sec[SEC_DATA].align);
+    offset[SEC_BSS] = 0;
+    
+    addr[SEC_TEXT] = ELF_BASE + offset[SEC_TEXT];
+    addr[SEC_RODATA] = ELF_BASE + offset[SEC_RODATA];
+    // The data segment starts on a fresh page congruent to its file offset
+    addr[SEC_DATA] = align_up(ELF_BASE + offset[SEC_DATA], PAGE_SIZE) + offset[SEC_DATA] % PAGE_SIZE;
+    addr[SEC_BSS] = align_up(addr[SEC_DATA] + sec[SEC_DATA].data.size, sec[SEC_BSS].align);
+    
+    asm_link(a, addr);
+    
+    uint8_t header[ELF_HEADER_SIZE] = { 0 };
+    const Label *start = &a->labels[entry];
+    uint64_t data_end = addr[SEC_BSS] + sec[SEC_BSS].data.size;
+    
+    memcpy(header, "\x7f" "ELF\x02\x01\x01", 7);    // ELF64, little endian, SysV
+    put_le(header + 16, 2, 2);                      // ET_EXEC
+    put_le(header + 18, 0x3e, 2);                   // EM_X86_64
+    put_le(header + 20, 1, 4);                      // EV_CURRENT
+    put_le(header + 24, addr[start->section] + start->offset, 8);
+    put_le(header + 32, 64, 8);                     // program headers follow
+    put_le(header + 52, 64, 2);                     // ELF header size
+    put_le(header + 54, 56, 2);                     // program header size
+    put_le(header + 56, 3, 2);                      // program header count
+    
+    uint8_t *ph = header + 64;
+    put_le(ph + 0, 1, 4);                           // PT_LOAD
+    put_le(ph + 4, 5, 4);                           // PF_R | PF_X
+    put_le(ph + 16, ELF_BASE, 8);
+    put_le(ph + 24, ELF_BASE, 8);
+    put_le(ph + 32, code_end, 8);
+    put_le(ph + 40, code_end, 8);
+    put_le(ph + 48, PAGE_SIZE, 8);
+    
+    ph += 56;
+    put_le(ph + 0, 1, 4);                           // PT_LOAD
+    put_le(ph + 4, 6, 4);                           // PF_R | PF_W
+    put_le(ph + 8, offset[SEC_DATA], 8);
+    put_le(ph + 16, addr[SEC_DATA], 8);
+    put_le(ph + 24, addr[SEC_DATA], 8);
+    put_le(ph + 32, sec[SEC_DATA].data.size, 8);
+    put_le(ph + 40, data_end - addr[SEC_DATA], 8);
+    put_le(ph + 48, PAGE_SIZE, 8);
+    
+    ph += 56;
+    put_le(ph + 0, 0x6474e551, 4);                  // PT_GNU_STACK
+    put_le(ph + 4, 6, 4);                           // non-executable stack
+    
+    static const uint8_t zeros[64];
+    uint64_t written = sizeof(header);
+    sink_write(out, header, sizeof(header));
+    for (int i = SEC_TEXT; i <= SEC_DATA; i++) {
+        while (written < offset[i]) {
+            size_t pad = offset[i] - written < sizeof(zeros) ? offset[i] - written : sizeof(zeros);
+            sink_write(out, zeros, pad);
+            written += pad;
+        }
+        sink_write(out, sec[i].data.bytes, sec[i].data.size);
+        written += sec[i].data.size;
+    }
+}
+
+// Map the encoded sections into this process and call `entry` as a
+// function. Code and constants are remapped read+execute before the call;
+// data and bss (I/O buffers, static tape) stay writable, and untouched
+// bss pages are never backed by memory. The mapping is recorded in the
+// Compiler before linking, so bfc_compile unmaps it if anything fails.
+static void asm_run(Compiler *c, int entry) {
+    Asm *a = c->as;
+    const Section *sec = a->sections;
+    uint64_t offset[SEC_COUNT];
+    uint64_t addr[SEC_COUNT];
+    
+    offset[SEC_TEXT] = 0;
+    offset[SEC_RODATA] = align_up(sec[SEC_TEXT].data.size, sec[SEC_RODATA].align);
+    uint64_t code_size = align_up(offset[SEC_RODATA] + sec[SEC_RODATA].data.size, PAGE_SIZE);
+    offset[SEC_DATA] = code_size;
+    offset[SEC_BSS] = align_up(offset[SEC_DATA] + sec[SEC_DATA].data.size, sec[SEC_BSS].align);
+    size_t total = align_up(offset[SEC_BSS] + sec[SEC_BSS].data.size, PAGE_SIZE);
+    
+    uint8_t *base = mmap(NULL, total, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (base == MAP_FAILED) {
+        fail(BFC_ERR_MEMORY, "Could not map %zu bytes for the program", total);
+    }
+    c->mapping = base;
+    c->mapping_size = total;
+    
+    for (int i = 0; i < SEC_COUNT; i++) {
+        addr[i] = (uint64_t)(uintptr_t)base + offset[i];
+    }
+    asm_link(a, addr);
+    for (int i = SEC_TEXT; i <= SEC_DATA; i++) {
+        if (sec[i].data.size) memcpy(base + offset[i], sec[i].data.bytes, sec[i].data.size);
+    }
+    
+    if (mprotect(base, code_size, PROT_READ | PROT_EXEC) != 0) {
+        fail(BFC_ERR_MEMORY, "Could not make the program executable");
+    }
+    
+    const Label *start = &a->labels[entry];
+    int (*program)(void) = (int (*)(void))(uintptr_t)(addr[start->section] + start->offset);
+    int status = program();
+    
+    release_mapping(c);
+    
+    // The program has already written its own message to stderr
+    if (status == 1) {
+        fail(BFC_ERR_RUNTIME, "The program could not write its output");
+    } else if (status != 0) {
+        fail(BFC_ERR_RUNTIME, "The program accessed the tape out of bounds");
+    }
+}
+
+// Queue a constant string for emit_data
+static void push_string(Compiler *c, int label, int start, int length) {
+    c->strings = grow_array(&c->arena, c->strings, &c->string_capacity, c->string_count + 1, sizeof(PendingString));
+    c->strings[c->string_count].label = label;
+    c->strings[c->string_count].start = start;
+    c->strings[c->string_count].length = length;
+    c->string_count++;
+}
+
+// Bytes mapped for the tape in TAPE_MMAP mode: guard page, padding, the
+// tape rounded up to whole pages, padding, guard page
+static size_t mapped_tape_size(const Compiler *c) {
+    size_t body = c->options.tape_size * c->options.cell_size + 2 * SCAN_BLOCK;
+    body = (body + PAGE_SIZE - 1) / PAGE_SIZE * PAGE_SIZE;
+    return body + 2 * PAGE_SIZE;
+}
+
+// Bytes per cell
+static int cell_width(const Compiler *c) {
+    return c->options.cell_size;
+}
+
+// Memory operand addressing cell[offset]
+static Operand cell_at(const Compiler *c, int offset) {
+    return mem(R12, (long long)offset * c->options.cell_size);
+}
+
+static const int cell_registers[CELL_REGS] = { RBX, R8, R9, R10 };
+
+// Register holding cell[offset] in the current loop, or its memory operand
+static Operand cell_operand(const Compiler *c, int offset) {
+    for (int k = 0; k < c->cell_reg_count; k++) {
+        if (c->cell_regs[k] == offset) {
+            return reg(cell_registers[k]);
+        }
+    }
+    return cell_at(c, offset);
+}
+
+// Emit a system call; the arguments are already in place
+static void emit_syscall(Compiler *c, int number, const char *name) {
+    asm_note(c->as, name);
+    asm_op(c->as, I_MOV, 8, imm(number), reg(RAX));
+    asm_op0(c->as, I_SYSCALL);
+}
+
+static const char tape_error[] = "bf: tape access out of bounds\n";
+
+// A JIT program returns to its host, so it must unmap an mmap tape and put
+// back the host's SIGSEGV handler when it ends
+static bool jit_owns_tape(const Compiler *c) {
+    return c->options.format == FORMAT_JIT && c->options.tape_mode == TAPE_MMAP;
+}
+
+// Put back the host's SIGSEGV handler and unmap the tape. Skipped when the
+// tape base is still zero: the mapping failed before the handler went in.
+static void emit_release_tape(Compiler *c) {
+    Asm *a = c->as;
+    int done = asm_new_label(a, "bf_released", next_label(c));
+    
+    asm_raw(a, "    # Restore the host's SIGSEGV handler and unmap the tape\n");
+    asm_op(a, I_MOV, 8, rip(c->runtime[RT_TAPE_BASE], 0), reg(RDI));
+    asm_op(a, I_TEST, 8, reg(RDI), reg(RDI));
+    asm_jcc(a, CC_E, done);
+    asm_note(a, "SIGSEGV");
+    asm_op(a, I_MOV, 8, imm(11), reg(RDI));
+    asm_op(a, I_LEA, 8, rip(c->runtime[RT_OLD_SIGACTION], 0), reg(RSI));
+    asm_op(a, I_XOR, 8, reg(RDX), reg(RDX));
+    asm_note(a, "sizeof(sigset_t)");
+    asm_op(a, I_MOV, 8, imm(8), reg(R10));
+    emit_syscall(c, 13, "sys_rt_sigaction");
+    asm_op(a, I_MOV, 8, rip(c->runtime[RT_TAPE_BASE], 0), reg(RDI));
+    asm_op(a, I_SUB, 8, imm(PAGE_SIZE + SCAN_BLOCK), reg(RDI));
+    asm_op(a, I_MOV, 8, imm((long long)mapped_tape_size(c)), reg(RSI));
+    emit_syscall(c, 11, "sys_munmap");
+    asm_bind(a, done);
+}
+
+// Emit assembly header
+static void emit_header(Compiler *c) {
+    Asm *a = c->as;
+    int *rt = c->runtime;
+    
+    // I/O buffers and loop counters come first so they stay within rel32
+    // reach of the code however large the tape is
+    asm_section(a, SEC_BSS);
+    asm_align(a, 64);
+    asm_bind(a, rt[RT_OUT_BUF]);
+    asm_zero(a, OUTPUT_BUFFER_SIZE);
+    asm_bind(a, rt[RT_IN_BUF]);
+    asm_zero(a, INPUT_BUFFER_SIZE);
+    if (c->checks || c->options.dump_tape || jit_owns_tape(c)) {
+        asm_bind(a, rt[RT_TAPE_BASE]);
+        asm_zero(a, 8);
+    }
+    if (jit_owns_tape(c)) {
+        asm_bind(a, rt[RT_OLD_SIGACTION]);
+        asm_zero(a, 32);
+    }
+    if (c->options.format == FORMAT_JIT) {
+        asm_bind(a, rt[RT_HOST_STACK]);
+        asm_zero(a, 8);
+    }
+    if (c->options.profile) {
+        asm_bind(a, rt[RT_PROFILE]);
+        if (c->profile_count) {
+            asm_zero(a, 16 * c->profile_count);
+        }
+    }
+    
+    // The tape is padded so vector scans can read a full block near its ends
+    if (c->options.tape_mode == TAPE_STATIC) {
+        asm_zero(a, SCAN_BLOCK);
+        asm_bind(a, rt[RT_MEMORY]);
+        asm_zero(a, c->options.tape_size * c->options.cell_size);
+        asm_zero(a, SCAN_BLOCK);
+    } else {
+        asm_section(a, SEC_DATA);
+        asm_align(a, 8);
+        asm_bind(a, rt[RT_SIGACTION]);
+        asm_quad_label(a, rt[RT_SEGV_HANDLER]);
+        asm_note(a, "SA_SIGINFO | SA_RESTORER");
+        asm_quad(a, 0x04000004);
+        asm_quad_label(a, rt[RT_SIGRETURN]);
+        asm_note(a, "blocked signals");
+        asm_quad(a, 0);
+        asm_section(a, SEC_RODATA);
+        asm_bind(a, rt[RT_TAPE_ERROR]);
+        asm_ascii(a, tape_error, sizeof(tape_error) - 1);
+    }
+    
+    asm_section(a, SEC_TEXT);
+    asm_raw(a, "    .globl _start\n\n");
+    asm_bind(a, rt[RT_START]);
+    
+    // Called as a function by the JIT host, which expects rbx and r12-r15
+    // intact. Errors unwind to the saved stack pointer and return too.
+    if (c->options.format == FORMAT_JIT) {
+        asm_op1(a, I_PUSH, 8, reg(RBX));
+        for (int r = R12; r <= R15; r++) {
+            asm_op1(a, I_PUSH, 8, reg(r));
+        }
+        asm_op(a, I_MOV, 8, reg(RSP), rip(rt[RT_HOST_STACK], 0));
+    }
+    
+    if (c->options.tape_mode == TAPE_MMAP) {
+        size_t total = mapped_tape_size(c);
+    
+        asm_raw(a, "    # Map the tape; untouched pages cost nothing\n");
+        asm_op(a, I_XOR, 8, reg(RDI), reg(RDI));
+        asm_op(a, I_MOV, 8, imm((long long)total), reg(RSI));
+        asm_note(a, "PROT_READ | PROT_WRITE");
+        asm_op(a, I_MOV, 8, imm(3), reg(RDX));
+        asm_note(a, "MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE");
+        asm_op(a, I_MOV, 8, imm(0x4022), reg(R10));
+        asm_op(a, I_MOV, 8, imm(-1), reg(R8));
+        asm_op(a, I_XOR, 8, reg(R9), reg(R9));
+        emit_syscall(c, 9, "sys_mmap");
+        asm_op(a, I_CMP, 8, imm(-4095), reg(RAX));
+        asm_jcc(a, CC_AE, rt[RT_WRITE_ERROR]);
+        asm_op(a, I_LEA, 8, mem(RAX, PAGE_SIZE + SCAN_BLOCK), reg(R12));
+    
+        asm_raw(a, "    # Guard pages below and above the tape\n");
+        asm_op(a, I_MOV, 8, reg(RAX), reg(RDI));
+        asm_op(a, I_MOV, 8, imm(PAGE_SIZE), reg(RSI));
+        asm_note(a, "PROT_NONE");
+        asm_op(a, I_XOR, 8, reg(RDX), reg(RDX));
+        emit_syscall(c, 10, "sys_mprotect");
+        asm_op(a, I_MOV, 8, imm((long long)(total - PAGE_SIZE)), reg(RCX));
+        asm_op(a, I_ADD, 8, reg(RCX), reg(RDI));
+        emit_syscall(c, 10, "sys_mprotect");
+    
+        asm_raw(a, "    # Report guard page hits instead of dying silently\n");
+        asm_note(a, "SIGSEGV");
+        asm_op(a, I_MOV, 8, imm(11), reg(RDI));
+        asm_op(a, I_LEA, 8, rip(rt[RT_SIGACTION], 0), reg(RSI));
+        if (jit_owns_tape(c)) {
+            asm_op(a, I_LEA, 8, rip(rt[RT_OLD_SIGACTION], 0), reg(RDX));
+        } else {
+            asm_op(a, I_XOR, 8, reg(RDX), reg(RDX));
+        }
+        asm_note(a, "sizeof(sigset_t)");
+        asm_op(a, I_MOV, 8, imm(8), reg(R10));
+        emit_syscall(c, 13, "sys_rt_sigaction");
+    } else {
+        asm_op(a, I_LEA, 8, rip(rt[RT_MEMORY], 0), reg(R12));
+    }
+    if (c->checks || c->options.dump_tape || jit_owns_tape(c)) {
+        asm_note(a, "cell 0, for bounds checks, --dump-tape and unmapping");
+        asm_op(a, I_MOV, 8, reg(R12), rip(rt[RT_TAPE_BASE], 0));
+    }
+    
+    asm_raw(a, "    # Data pointer in r12, output cursor in r13,\n");
+    asm_raw(a, "    # input cursor and end in r14/r15 (buffer starts empty)\n");
+    asm_op(a, I_LEA, 8, rip(rt[RT_OUT_BUF], 0), reg(R13));
+    asm_op(a, I_LEA, 8, rip(rt[RT_IN_BUF], 0), reg(R14));
+    asm_op(a, I_MOV, 8, reg(R14), reg(R15));
+    asm_raw(a, "\n");
+}
+
+// Emit assembly footer and the runtime support routines
+static void emit_footer(Compiler *c) {
+    Asm *a = c->as;
+    int *rt = c->runtime;
+    int flush_loop = asm_new_label(a, "bf_flush_loop", -1);
+    int flush_done = asm_new_label(a, "bf_flush_done", -1);
+    int getchar_ready = asm_new_label(a, "bf_getchar_ready", -1);
+    int fill = asm_new_label(a, "bf_fill", -1);
+    int eof = asm_new_label(a, "bf_eof", -1);
+    int write_next = asm_new_label(a, "bf_write_next", -1);
+    
+    asm_raw(a, "\n    # Exit program\n");
+    asm_call(a, rt[RT_FLUSH]);
+    if (c->options.dump_tape) {
+        int dump_next = asm_new_label(a, "bf_dump_next", -1);
+        asm_raw(a, "    # Write the tape to stderr\n");
+        asm_op(a, I_MOV, 8, rip(rt[RT_TAPE_BASE], 0), reg(RSI));
+        asm_op(a, I_MOV, 8, imm((long long)(c->options.tape_size * c->options.cell_size)), reg(RDX));
+        asm_bind(a, dump_next);
+        asm_note(a, "stderr");
+        asm_op(a, I_MOV, 8, imm(2), reg(RDI));
+        emit_syscall(c, 1, "sys_write");
+        asm_op(a, I_TEST, 8, reg(RAX), reg(RAX));
+        asm_jcc(a, CC_LE, rt[RT_WRITE_ERROR]);
+        asm_op(a, I_ADD, 8, reg(RAX), reg(RSI));
+        asm_op(a, I_SUB, 8, reg(RAX), reg(RDX));
+        asm_jcc(a, CC_NE, dump_next);
+    }
+    if (c->options.profile) {
+        asm_call(a, rt[RT_PROFILE_DUMP]);
+    }
+    if (c->options.format == FORMAT_JIT) {
+        asm_note(a, "status 0");
+        asm_op(a, I_XOR, 4, reg(RBX), reg(RBX));
+        asm_bind(a, rt[RT_RETURN]);
+        if (jit_owns_tape(c)) {
+            emit_release_tape(c);
+        }
+        asm_op(a, I_MOV, 8, reg(RBX), reg(RAX));
+        for (int r = R15; r >= R12; r--) {
+            asm_op1(a, I_POP, 8, reg(r));
+        }
+        asm_op1(a, I_POP, 8, reg(RBX));
+        asm_op0(a, I_RET);
+    } else {
+        asm_note(a, "exit code 0");
+        asm_op(a, I_XOR, 8, reg(RDI), reg(RDI));
+        emit_syscall(c, 60, "sys_exit");
+    }
+    asm_raw(a, "\n");
+    
+    // bf_putchar: append %al to the output buffer, flushing when it fills
+    asm_bind(a, rt[RT_PUTCHAR]);
+    asm_op(a, I_MOV, 1, reg(RAX), mem(R13, 0));
+    asm_op1(a, I_INC, 8, reg(R13));
+    asm_op(a, I_LEA, 8, rip(rt[RT_OUT_BUF], OUTPUT_BUFFER_SIZE), reg(RAX));
+    asm_op(a, I_CMP, 8, reg(RAX), reg(R13));
+    asm_jcc(a, CC_AE, rt[RT_FLUSH]);
+    asm_op0(a, I_RET);
+    asm_raw(a, "\n");
+    
+    // bf_flush: write out_buf up to %r13, retrying short writes
+    asm_bind(a, rt[RT_FLUSH]);
+    asm_op(a, I_LEA, 8, rip(rt[RT_OUT_BUF], 0), reg(RSI));
+    asm_bind(a, flush_loop);
+    asm_op(a, I_MOV, 8, reg(R13), reg(RDX));
+    asm_note(a, "bytes pending");
+    asm_op(a, I_SUB, 8, reg(RSI), reg(RDX));
+    asm_jcc(a, CC_E, flush_done);
+    asm_note(a, "stdout");
+    asm_op(a, I_MOV, 8, imm(1), reg(RDI));
+    emit_syscall(c, 1, "sys_write");
+    asm_op(a, I_TEST, 8, reg(RAX), reg(RAX));
+    asm_jcc(a, CC_LE, rt[RT_WRITE_ERROR]);
+    asm_op(a, I_ADD, 8, reg(RAX), reg(RSI));
+    asm_jmp(a, flush_loop);
+    asm_bind(a, flush_done);
+    asm_op(a, I_LEA, 8, rip(rt[RT_OUT_BUF], 0), reg(R13));
+    asm_op0(a, I_RET);
+    asm_raw(a, "\n");
+    
+    // bf_getchar: store the next input byte at (%rdi), refilling in_buf
+    // with one large read when it runs dry
+    asm_bind(a, rt[RT_GETCHAR]);
+    asm_op(a, I_CMP, 8, reg(R15), reg(R14));
+    asm_jcc(a, CC_AE, fill);
+    asm_bind(a, getchar_ready);
+    asm_op(a, I_MOVZB, 4, mem(R14, 0), reg(RAX));
+    asm_op1(a, I_INC, 8, reg(R14));
+    asm_op(a, I_MOV, cell_width(c), reg(RAX), mem(RDI, 0));
+    asm_op0(a, I_RET);
+    asm_raw(a, "\n");
+    
+    asm_bind(a, fill);
+    asm_op1(a, I_PUSH, 8, reg(RDI));
+    asm_note(a, "show pending output first");
+    asm_call(a, rt[RT_FLUSH]);
+    asm_note(a, "stdin");
+    asm_op(a, I_XOR, 8, reg(RDI), reg(RDI));
+    asm_op(a, I_LEA, 8, rip(rt[RT_IN_BUF], 0), reg(RSI));
+    asm_op(a, I_MOV, 8, imm(INPUT_BUFFER_SIZE), reg(RDX));
+    emit_syscall(c, 0, "sys_read");
+    asm_op1(a, I_POP, 8, reg(RDI));
+    asm_op(a, I_TEST, 8, reg(RAX), reg(RAX));
+    asm_note(a, "end of input or read error");
+    asm_jcc(a, CC_LE, eof);
+    asm_op(a, I_LEA, 8, rip(rt[RT_IN_BUF], 0), reg(R14));
+    asm_op(a, I_LEA, 8, mem_index(R14, RAX, 0), reg(R15));
+    asm_jmp(a, getchar_ready);
+    
+    asm_bind(a, eof);
+    switch (c->options.eof_mode) {
+        case EOF_UNCHANGED:
+            break;
+        case EOF_ZERO:
+            asm_op(a, I_MOV, cell_width(c), imm(0), mem(RDI, 0));
+            break;
+        case EOF_MINUS_ONE:
+            asm_op(a, I_MOV, cell_width(c), imm(-1), mem(RDI, 0));
+            break;
+    }
+    asm_op0(a, I_RET);
+    asm_raw(a, "\n");
+    
+    // bf_write: copy %rdx bytes from %rsi into the output buffer
+    asm_bind(a, rt[RT_WRITE]);
+    asm_op(a, I_LEA, 8, rip(rt[RT_OUT_BUF], OUTPUT_BUFFER_SIZE), reg(RCX));
+    asm_note(a, "room left");
+    asm_op(a, I_SUB, 8, reg(R13), reg(RCX));
+    asm_op(a, I_CMP, 8, reg(RDX), reg(RCX));
+    asm_op(a, I_CMOVA, 8, reg(RDX), reg(RCX));
+    asm_op(a, I_SUB, 8, reg(RCX), reg(RDX));
+    asm_op(a, I_MOV, 8, reg(R13), reg(RDI));
+    asm_op0(a, I_REP_MOVSB);
+    asm_op(a, I_MOV, 8, reg(RDI), reg(R13));
+    asm_op(a, I_LEA, 8, rip(rt[RT_OUT_BUF], OUTPUT_BUFFER_SIZE), reg(RAX));
+    asm_op(a, I_CMP, 8, reg(RAX), reg(R13));
+    asm_jcc(a, CC_B, write_next);
+    asm_op1(a, I_PUSH, 8, reg(RSI));
+    asm_op1(a, I_PUSH, 8, reg(RDX));
+    asm_call(a, rt[RT_FLUSH]);
+    asm_op1(a, I_POP, 8, reg(RDX));
+    asm_op1(a, I_POP, 8, reg(RSI));
+    asm_bind(a, write_next);
+    asm_op(a, I_TEST, 8, reg(RDX), reg(RDX));
+    asm_jcc(a, CC_NE, rt[RT_WRITE]);
+    asm_op0(a, I_RET);
+    asm_raw(a, "\n");
+    
+    if (c->options.tape_mode == TAPE_MMAP) {
+        // Flush what the program printed so far, using the output cursor
+        // saved in the signal context (uc_mcontext.gregs[REG_R13]), then
+        // resume at bf_tape_fault (gregs[REG_RIP]) through rt_sigreturn so
+        // SIGSEGV is unblocked again
+        asm_bind(a, rt[RT_SEGV_HANDLER]);
+        asm_op(a, I_MOV, 8, reg(RDX), reg(RBX));
+        asm_op(a, I_MOV, 8, mem(RDX, 80), reg(R13));
+        asm_call(a, rt[RT_FLUSH]);
+        asm_note(a, "stderr");
+        asm_op(a, I_MOV, 8, imm(2), reg(RDI));
+        asm_op(a, I_LEA, 8, rip(rt[RT_TAPE_ERROR], 0), reg(RSI));
+        asm_op(a, I_MOV, 8, imm(sizeof(tape_error) - 1), reg(RDX));
+        emit_syscall(c, 1, "sys_write");
+        asm_op(a, I_LEA, 8, rip(rt[RT_TAPE_FAULT], 0), reg(RAX));
+        asm_op(a, I_MOV, 8, reg(RAX), mem(RBX, 168));
+        asm_op0(a, I_RET);
+        asm_raw(a, "\n");
+    
+        asm_bind(a, rt[RT_SIGRETURN]);
+        emit_syscall(c, 15, "sys_rt_sigreturn");
+        asm_raw(a, "\n");
+    }
+    
+    // A JIT program hands its host status 1 for an output error and 2 for
+    // a tape access out of bounds; an executable exits with code 1
+    asm_bind(a, rt[RT_TAPE_FAULT]);
+    if (c->options.format == FORMAT_JIT) {
+        int leave = asm_new_label(a, "bf_leave", -1);
+        
+        asm_op(a, I_MOV, 4, imm(2), reg(RBX));
+        asm_jmp(a, leave);
+        asm_bind(a, rt[RT_WRITE_ERROR]);
+        asm_op(a, I_MOV, 4, imm(1), reg(RBX));
+        asm_bind(a, leave);
+        asm_op(a, I_MOV, 8, rip(rt[RT_HOST_STACK], 0), reg(RSP));
+        asm_jmp(a, rt[RT_RETURN]);
+    } else {
+        asm_bind(a, rt[RT_WRITE_ERROR]);
+        asm_note(a, "exit code 1");
+        asm_op(a, I_MOV, 8, imm(1), reg(RDI));
+        emit_syscall(c, 60, "sys_exit");
+    }
+}
+
+// IR operation types produced by the parser and consumed by the backend
+typedef enum {
+    OP_ADD,     // cell[offset] += arg
+    OP_MOVE,    // pointer += arg
+    OP_OUT,     // write cell[offset] to stdout
+    OP_IN,      // read stdin into cell[offset]
+    OP_JZ,      // [ : jump past matching OP_JNZ (index in arg) if cell is zero
+    OP_JNZ,     // ] : jump back to matching OP_JZ (index in arg) if cell is non-zero
+    OP_CLEAR,   // cell[offset] = 0
+    OP_MUL,     // cell[offset] += arg * cell[src]
+    OP_PRINT,   // write arg constant bytes from the data pool, starting at src
+    OP_SCAN     // [>] / [<<] : move the pointer by arg until the cell is zero
+} OpType;
+
+typedef struct {
+    OpType type;
+    int arg;
+    int offset;     // cell operand, relative to the data pointer
+    int src;        // source cell for OP_MUL, relative to the data pointer;
+                    // bracket number of the '[' for OP_JZ and OP_SCAN
+} Op;
+
+struct Program {
+    Arena *arena;
+    Op *ops;
+    size_t count;
+    size_t capacity;
+    char *data;             // constant output bytes referenced by OP_PRINT
+    size_t data_length;
+    size_t data_capacity;
+    int cell_size;          // bytes per cell, for wrapping arithmetic
+    size_t tape_size;       // cells, for evaluating the program at compile time
+    bool dump_tape;         // the final tape is observable, see --dump-tape
+    size_t scan_loops;      // loops recognized by the passes, see bfc_stats
+    size_t clear_loops;
+    size_t mul_loops;
+    size_t dead_loops;
+};
+
+// Optimization pass: rewrites the IR in place
+typedef void (*Pass)(Program *prog);
+
+// Brainfuck command characters; everything else is a comment
+static const bool is_command[256] = {
+    ['+'] = true, ['-'] = true, ['>'] = true, ['<'] = true,
+    ['.'] = true, [','] = true, ['['] = true, [']'] = true
+};
+
+// Create an empty program
+static Program *create_program(Arena *arena, size_t capacity) {
+    Program *prog = arena_alloc(arena, sizeof(Program));
+    
+    prog->arena = arena;
+    prog->capacity = 0;
+    prog->ops = grow_array(arena, NULL, &prog->capacity, capacity > 16 ? capacity : 16, sizeof(Op));
+    prog->count = 0;
+    prog->data = NULL;
+    prog->data_length = 0;
+    prog->data_capacity = 0;
+    prog->cell_size = 1;
+    prog->tape_size = MEMORY_SIZE;
+    prog->dump_tape = false;
+    prog->scan_loops = 0;
+    prog->clear_loops = 0;
+    prog->mul_loops = 0;
+    prog->dead_loops = 0;
+    
+    return prog;
+}
+
+// Append an operation to the program
+static void push_op(Program *prog, OpType type, int arg, int offset) {
+    prog->ops = grow_array(prog->arena, prog->ops, &prog->capacity, prog->count + 1, sizeof(Op));
+    
+    Op *op = &prog->ops[prog->count++];
+    op->type = type;
+    op->arg = arg;
+    op->offset = offset;
+    op->src = 0;
+}
+
+// Append a byte to the constant data pool
+static void push_data(Program *prog, char byte) {
+    prog->data = grow_array(prog->arena, prog->data, &prog->data_capacity, prog->data_length + 1, 1);
+    prog->data[prog->data_length++] = byte;
+}
+
+// Reduce a cell increment to the signed range of the cell width
+static int wrap_cell(const Program *prog, long long value) {
+    switch (prog->cell_size) {
+        case 1: return (int8_t)value;
+        case 2: return (int16_t)value;
+        default: return (int32_t)value;
+    }
+}
+
+// All-ones value of a cell
+static long long cell_mask(const Program *prog) {
+    return (1LL << (prog->cell_size * 8)) - 1;
+}
+
+// Optimize repeated instructions
+static int count_repeats(Source *src, char instruction) {
+    int count = 0;
+    size_t pos = src->position;
+    while (pos < src->length && src->code[pos] == instruction) {
+        count++;
+        pos++;
+    }
+    return count;
+}
+
+
+// Report an error at a byte offset of the source as file:line:column
+static void source_error(const Source *src, size_t pos, const char *msg) {
+    size_t line = 1;
+    size_t column = 1;
+    for (size_t i = 0; i < pos; i++) {
+        if (src->code[i] == '\n') {
+            line++;
+            column = 1;
+        } else {
+            column++;
+        }
+    }
+    fail(BFC_ERR_SYNTAX, "%s:%zu:%zu: error: %s", src->name, line, column, msg);
+}
+
+// Byte offset of bracket number `bracket`, counting '[' and ']' from the start
+static size_t bracket_position(const Source *src, int bracket) {
+    size_t pos = 0;
+    for (int seen = -1; ; pos++) {
+        if (src->code[pos] == '[' || src->code[pos] == ']') {
+            if (++seen == bracket) break;
+        }
+    }
+    return pos;
+}
+
+// Pair up the brackets of the source in a single pass. Brackets are numbered
+// in source order and brackets[k] holds the number of the partner of bracket
+// k. While a '[' is still open its entry links to the '[' enclosing it, so
+// the table doubles as the stack and nothing else is allocated. Unbalanced
+// input is reported here, before an output file is touched.
+static void match_brackets(Arena *arena, Source *src) {
+    size_t capacity = 0;
+    int *brackets = grow_array(arena, NULL, &capacity, 1, sizeof(int));
+    int count = 0;
+    int open = -1;
+    
+    for (size_t i = 0; i < src->length; i++) {
+        char ch = src->code[i];
+        if (ch != '[' && ch != ']') {
+            continue;
+        }
+        if (count == INT_MAX) {
+            fail(BFC_ERR_LIMIT, "Program too large: too many brackets");
+        }
+        brackets = grow_array(arena, brackets, &capacity, (size_t)count + 1, sizeof(int));
+        if (ch == '[') {
+            brackets[count] = open;
+            open = count;
+        } else {
+            if (open < 0) {
+                source_error(src, i, "unmatched ']'");
+            }
+            int partner = open;
+            open = brackets[partner];
+            brackets[partner] = count;
+            brackets[count] = partner;
+        }
+        count++;
+    }
+    
+    if (open >= 0) {
+        // Report the outermost '[' left open, the one that starts the damage
+        while (brackets[open] >= 0) {
+            open = brackets[open];
+        }
+        source_error(src, bracket_position(src, open), "unmatched '['");
+    }
+    
+    src->brackets = brackets;
+    src->bracket_count = (size_t)count;
+}
+
+// Slice of a large source lexed on its own thread. The first pass counts
+// what the slice holds; the second writes its operations and bracket pairs
+// straight into the program at the positions the counts give it.
+typedef struct {
+    const Source *src;
+    Program *prog;
+    size_t start;
+    size_t end;
+    size_t op_count;        // operations, from the counting pass
+    int bracket_count;
+    int depth;              // '[' minus ']'
+    int min_depth;          // lowest depth reached, <= 0
+    size_t op_base;         // first operation and bracket of the slice
+    int bracket_base;
+    int *jump_ops;          // bracket number -> IR index, shared by all slices
+    int *closes;            // ']' left unmatched inside the slice, in order
+    int open;               // innermost '[' left open, linked as in match_brackets
+} ParseChunk;
+
+// Counting pass: operations and the bracket depth profile of a slice
+static void *count_chunk(void *arg) {
+    ParseChunk *chunk = arg;
+    const char *code = chunk->src->code;
+    size_t ops = 0;
+    int brackets = 0;
+    int depth = 0;
+    int min_depth = 0;
+    
+    for (size_t i = chunk->start; i < chunk->end; i++) {
+        unsigned char ch = code[i];
+        if (!is_command[ch]) continue;
+        if (ch == '[') {
+            depth++;
+            brackets++;
+        } else if (ch == ']') {
+            depth--;
+            brackets++;
+            if (depth < min_depth) min_depth = depth;
+        } else if ((ch == '+' || ch == '-' || ch == '>' || ch == '<') &&
+                   i > chunk->start && code[i - 1] == ch) {
+            continue;
+        }
+        ops++;
+    }
+    
+    chunk->op_count = ops;
+    chunk->bracket_count = brackets;
+    chunk->depth = depth;
+    chunk->min_depth = min_depth;
+    return NULL;
+}
+
+// Lexing pass: the same operations parse() builds, with brackets paired
+// inside the slice. The ones left over are paired by stitch_chunks.
+static void *lex_chunk(void *arg) {
+    ParseChunk *chunk = arg;
+    const Source *src = chunk->src;
+    Program *prog = chunk->prog;
+    int *brackets = src->brackets;
+    Op *op = &prog->ops[chunk->op_base];
+    int bracket = chunk->bracket_base;
+    int open = -1;
+    int closes = 0;
+    
+    for (size_t i = chunk->start; i < chunk->end; ) {
+        unsigned char ch = src->code[i];
+        size_t count = 1;
+        if (!is_command[ch]) {
+            i++;
+            continue;
+        }
+        
+        int index = (int)(op - prog->ops);
+        op->offset = 0;
+        op->src = 0;
+        switch (ch) {
+            case '+':
+            case '-':
+            case '>':
+            case '<':
+                while (i + count < chunk->end && src->code[i + count] == ch) count++;
+                if (ch == '+' || ch == '-') {
+                    op->type = OP_ADD;
+                    op->arg = wrap_cell(prog, ch == '+' ? (long long)count : -(long long)count);
+                } else {
+                    op->type = OP_MOVE;
+                    op->arg = ch == '>' ? (int)count : -(int)count;
+                }
+                break;
+                
+            case '.':
+                op->type = OP_OUT;
+                op->arg = 0;
+                break;
+                
+            case ',':
+                op->type = OP_IN;
+                op->arg = 0;
+                break;
+                
+            case '[':
+                op->type = OP_JZ;
+                op->arg = 0;
+                op->src = bracket;
+                chunk->jump_ops[bracket] = index;
+                brackets[bracket] = open;
+                open = bracket++;
+                break;
+                
+            case ']':
+                op->type = OP_JNZ;
+                op->arg = 0;
+                chunk->jump_ops[bracket] = index;
+                if (open < 0) {
+                    chunk->closes[closes++] = bracket;
+                } else {
+                    int partner = open;
+                    open = brackets[partner];
+                    brackets[partner] = bracket;
+                    brackets[bracket] = partner;
+                    op->arg = chunk->jump_ops[partner];
+                    prog->ops[op->arg].arg = index;
+                }
+                bracket++;
+                break;
+        }
+        
+        op++;
+        i += count;
+    }
+    
+    chunk->open = open;
+    return NULL;
+}
+
+// Run `work` on every chunk, one thread each; the calling thread takes the
+// first chunk and any a thread could not be started for
+static void run_chunks(ParseChunk *chunks, int count, void *(*work)(void *)) {
+    pthread_t threads[MAX_PARSE_CHUNKS];
+    bool started[MAX_PARSE_CHUNKS] = { false };
+    for (int i = 1; i < count; i++) {
+        started[i] = pthread_create(&threads[i], NULL, work, &chunks[i]) == 0;
+    }
+    for (int i = 0; i < count; i++) {
+        if (!started[i]) {
+            work(&chunks[i]);
+        }
+    }
+    for (int i = 1; i < count; i++) {
+        if (started[i]) {
+            pthread_join(threads[i], NULL);
+        }
+    }
+}
+
+// Pair the brackets no slice could pair on its own. Each slice reduces to
+// "]]..][[..[", so walking the slices in order with one stack of open
+// brackets is a prefix over their depths and touches only the leftovers.
+static void stitch_chunks(Source *src, Program *prog, ParseChunk *chunks, int count) {
+    int *brackets = src->brackets;
+    int open = -1;
+    
+    for (int i = 0; i < count; i++) {
+        ParseChunk *chunk = &chunks[i];
+        for (int k = 0; k < -chunk->min_depth; k++) {
+            int close = chunk->closes[k];
+            if (open < 0) {
+                source_error(src, bracket_position(src, close), "unmatched ']'");
+            }
+            int partner = open;
+            open = brackets[partner];
+            brackets[partner] = close;
+            brackets[close] = partner;
+            int start = chunk->jump_ops[partner];
+            int end = chunk->jump_ops[close];
+            prog->ops[start].arg = end;
+            prog->ops[end].arg = start;
+        }
+        
+        // Push the slice's open brackets, outermost first, onto the stack
+        if (chunk->open >= 0) {
+            int outer = chunk->open;
+            while (brackets[outer] >= 0) {
+                outer = brackets[outer];
+            }
+            brackets[outer] = open;
+            open = chunk->open;
+        }
+    }
+    
+    if (open >= 0) {
+        while (brackets[open] >= 0) {
+            open = brackets[open];
+        }
+        source_error(src, bracket_position(src, open), "unmatched '['");
+    }
+}
+
+// parse() for sources of several PARSE_CHUNK_SIZE slices: count and lex the
+// slices on separate threads, then pair the brackets that cross slices.
+// Slices never split a run of one instruction, so the IR is exactly the one
+// the sequential loop builds.
+static Program *parse_chunks(Compiler *c, Source *src, int count) {
+    ParseChunk chunks[MAX_PARSE_CHUNKS];
+    size_t start = 0;
+    for (int i = 0; i < count; i++) {
+        size_t end = i + 1 == count ? src->length : src->length / (size_t)count * (size_t)(i + 1);
+        if (end < start) end = start;
+        while (end < src->length && end > 0 && strchr("+-<>", src->code[end]) &&
+               src->code[end] == src->code[end - 1]) {
+            end++;
+        }
+        chunks[i] = (ParseChunk){ .src = src, .start = start, .end = end };
+        start = end;
+    }
+    run_chunks(chunks, count, count_chunk);
+    
+    // Prefix sums place every slice in the IR and the bracket table
+    size_t ops = 0;
+    size_t brackets = 0;
+    for (int i = 0; i < count; i++) {
+        chunks[i].op_base = ops;
+        chunks[i].bracket_base = (int)brackets;
+        ops += chunks[i].op_count;
+        brackets += (size_t)chunks[i].bracket_count;
+        if (ops > INT_MAX) {
+            fail(BFC_ERR_LIMIT, "Program too large: too many instructions");
+        }
+        if (brackets >= INT_MAX) {
+            fail(BFC_ERR_LIMIT, "Program too large: too many brackets");
+        }
+    }
+    
+    Program *prog = create_program(&c->arena, ops);
+    prog->count = ops;
+    prog->cell_size = c->options.cell_size;
+    prog->tape_size = c->options.tape_size;
+    prog->dump_tape = c->options.dump_tape;
+    src->brackets = arena_alloc(&c->arena, sizeof(int) * (brackets ? brackets : 1));
+    src->bracket_count = brackets;
+    int *jump_ops = arena_alloc(&c->arena, sizeof(int) * (brackets ? brackets : 1));
+    for (int i = 0; i < count; i++) {
+        chunks[i].prog = prog;
+        chunks[i].jump_ops = jump_ops;
+        chunks[i].closes = arena_alloc(&c->arena, sizeof(int) * (size_t)(1 - chunks[i].min_depth));
+    }
+    
+    run_chunks(chunks, count, lex_chunk);
+    stitch_chunks(src, prog, chunks, count);
+    src->position = src->length;
+    return prog;
+}
+
+// Threads the front end may use on a source of `length` bytes
+static int parse_chunk_count(size_t length) {
+    size_t slices = length / PARSE_CHUNK_SIZE;
+    if (slices < 2) return 1;
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cpus < 1) cpus = 1;
+    if (slices > (size_t)cpus) slices = (size_t)cpus;
+    return slices > MAX_PARSE_CHUNKS ? MAX_PARSE_CHUNKS : (int)slices;
+}
+
+// Build the IR from source, combining runs of repeated instructions
+static Program *parse(Compiler *c, Source *src) {
+    int chunks = src->brackets ? 1 : parse_chunk_count(src->length);
+    if (chunks > 1) {
+        return parse_chunks(c, src, chunks);
+    }
+    
+    Program *prog = create_program(&c->arena, src->length / 2);
+    if (!src->brackets) {
+        match_brackets(&c->arena, src);
+    }
+    
+    // IR index of each '[', looked up through the bracket table at its ']'
+    int *jump_ops = arena_alloc(&c->arena, sizeof(int) * src->bracket_count);
+    int bracket = 0;
+    prog->cell_size = c->options.cell_size;
+    prog->tape_size = c->options.tape_size;
+    prog->dump_tape = c->options.dump_tape;
+    
+    while (src->position < src->length) {
+        unsigned char ch = src->code[src->position];
+        int count = 1;
+        
+        // Only compile valid Brainfuck instructions
+        if (!is_command[ch]) {
+            src->position++;
+            continue;
+        }
+        
+        switch (ch) {
+            case '+':
+            case '-':
+            case '>':
+            case '<':
+                count = count_repeats(src, ch);
+                if (ch == '+' || ch == '-') {
+                    push_op(prog, OP_ADD, wrap_cell(prog, ch == '+' ? count : -count), 0);
+                } else {
+                    push_op(prog, OP_MOVE, ch == '>' ? count : -count, 0);
+                }
+                break;
+                
+            case '.':
+                push_op(prog, OP_OUT, 0, 0);
+                break;
+                
+            case ',':
+                push_op(prog, OP_IN, 0, 0);
+                break;
+                
+            case '[':
+                jump_ops[bracket] = (int)prog->count;
+                push_op(prog, OP_JZ, 0, 0);
+                prog->ops[prog->count - 1].src = bracket++;
+                break;
+                
+            case ']': {
+                int start = jump_ops[src->brackets[bracket++]];
+                prog->ops[start].arg = (int)prog->count;
+                push_op(prog, OP_JNZ, start, 0);
+                break;
+            }
+        }
+        
+        src->position += count;
+    }
+    
+    return prog;
+}
+
+// Recompute jump targets after a pass has moved operations around
+static void link_jumps(Compiler *c, Program *prog) {
+    for (size_t i = 0; i < prog->count; i++) {
+        Op *op = &prog->ops[i];
+        if (op->type == OP_JZ) {
+            push_loop(c, (int)i);
+        } else if (op->type == OP_JNZ) {
+            int start = pop_loop(c);
+            prog->ops[start].arg = (int)i;
+            op->arg = start;
+        }
+    }
+}
+
+// Pass: merge adjacent additions and moves, drop the ones that cancel out
+static void pass_combine_runs(Program *prog) {
+    size_t out = 0;
+    
+    for (size_t i = 0; i < prog->count; i++) {
+        Op op = prog->ops[i];
+        Op *prev = out > 0 ? &prog->ops[out - 1] : NULL;
+        
+        if (prev && op.type == OP_ADD && prev->type == OP_ADD &&
+            prev->offset == op.offset) {
+            prev->arg = wrap_cell(prog, (long long)prev->arg + op.arg);
+        } else if (prev && op.type == OP_MOVE && prev->type == OP_MOVE) {
+            prev->arg += op.arg;
+        } else {
+            prog->ops[out++] = op;
+            continue;
+        }
+        
+        if (prev->arg == 0) {
+            out--;
+        }
+    }
+    
+    prog->count = out;
+}
+
+// Pass: recognize scan loops, whose body is a single pointer move
+static void pass_scan_loops(Program *prog) {
+    size_t out = 0;
+    
+    for (size_t i = 0; i < prog->count; i++) {
+        Op *op = &prog->ops[i];
+        
+        if (op->type == OP_JZ && (size_t)op->arg == i + 2 &&
+            prog->ops[i + 1].type == OP_MOVE) {
+            Op *scan = &prog->ops[out++];
+            scan->type = OP_SCAN;
+            scan->arg = prog->ops[i + 1].arg;
+            scan->offset = 0;
+            scan->src = op->src;    // bracket of the '[', for diagnostics
+            prog->scan_loops++;
+            i += 2;
+            continue;
+        }
+        
+        prog->ops[out++] = *op;
+    }
+    
+    prog->count = out;
+}
+
+// Largest loop body considered by the loop pattern passes
+#define MAX_PATTERN_OPS 64
+
+// Pass: lower [-], [->+<], [->++>+++<<] and friends to straight-line code.
+// A candidate loop holds only ADD/MOVE, has no net pointer movement and
+// steps its own cell by -1 or +1, so it runs exactly cell[0] (or
+// 256 - cell[0]) times and each other cell gets a fixed multiple of it.
+static void pass_mul_loops(Program *prog) {
+    size_t out = 0;
+    
+    for (size_t i = 0; i < prog->count; i++) {
+        Op *op = &prog->ops[i];
+        size_t end = (size_t)op->arg;
+        
+        if (op->type != OP_JZ || end - i - 1 > MAX_PATTERN_OPS) {
+            prog->ops[out++] = *op;
+            continue;
+        }
+        
+        int offsets[MAX_PATTERN_OPS];
+        int totals[MAX_PATTERN_OPS];
+        int used = 0;
+        int pos = 0;
+        bool simple = true;
+        
+        for (size_t j = i + 1; j < end && simple; j++) {
+            Op *body = &prog->ops[j];
+            if (body->type == OP_MOVE) {
+                pos += body->arg;
+            } else if (body->type == OP_ADD) {
+                int k = 0;
+                while (k < used && offsets[k] != pos + body->offset) k++;
+                if (k == used) {
+                    offsets[used] = pos + body->offset;
+                    totals[used++] = 0;
+                }
+                totals[k] = wrap_cell(prog, (long long)totals[k] + body->arg);
+            } else {
+                simple = false;
+            }
+        }
+        
+        int step = 0;
+        for (int k = 0; k < used; k++) {
+            if (offsets[k] == 0) step = totals[k];
+        }
+        
+        if (!simple || pos != 0 || (step != -1 && step != 1)) {
+            prog->ops[out++] = *op;
+            continue;
+        }
+        
+        // Counting up wraps through 256 - cell[0] iterations
+        size_t first = out;
+        for (int k = 0; k < used; k++) {
+            if (offsets[k] == 0 || totals[k] == 0) continue;
+            Op *mul = &prog->ops[out++];
+            mul->type = OP_MUL;
+            mul->arg = wrap_cell(prog, step == -1 ? totals[k] : -(long long)totals[k]);
+            mul->offset = offsets[k];
+            mul->src = 0;
+        }
+        Op *clear = &prog->ops[out++];
+        clear->type = OP_CLEAR;
+        clear->arg = 0;
+        clear->offset = 0;
+        clear->src = 0;
+        if (out - first > 1) {
+            prog->mul_loops++;
+        } else {
+            prog->clear_loops++;
+        }
+        
+        i = end;
+    }
+    
+    prog->count = out;
+}
+
+// Pass: fold pointer movement into cell offsets.
+// Moves are tracked as a virtual offset that is added to every cell operand
+// and only written back to the data pointer around loops. Loops whose body
+// has no net movement run entirely at the virtual offset and need no
+// write-back at all.
+static void pass_fold_offsets(Program *prog) {
+    bool *balanced = arena_alloc(prog->arena, sizeof(bool) * prog->count);
+    int *net = arena_alloc(prog->arena, sizeof(int) * (prog->count + 1));
+    size_t *starts = arena_alloc(prog->arena, sizeof(size_t) * (prog->count + 1));
+    memset(balanced, 0, sizeof(bool) * prog->count);
+    
+    // A loop is balanced if its moves cancel out and every nested loop is
+    // balanced too; net[] holds the running movement, INT_MIN once unknown
+    int depth = 0;
+    net[0] = 0;
+    for (size_t i = 0; i < prog->count; i++) {
+        Op *op = &prog->ops[i];
+        if (op->type == OP_MOVE && net[depth] != INT_MIN) {
+            net[depth] += op->arg;
+        } else if (op->type == OP_SCAN) {
+            net[depth] = INT_MIN;
+        } else if (op->type == OP_JZ) {
+            starts[++depth] = i;
+            net[depth] = 0;
+        } else if (op->type == OP_JNZ) {
+            balanced[starts[depth]] = net[depth] == 0;
+            depth--;
+            if (!balanced[op->arg]) net[depth] = INT_MIN;
+        }
+    }
+    
+    // Rewrite, materializing the virtual offset only around unbalanced loops
+    size_t out = 0;
+    int virt = 0;
+    for (size_t i = 0; i < prog->count; i++) {
+        Op op = prog->ops[i];
+        
+        if (op.type == OP_MOVE) {
+            virt += op.arg;
+            continue;
+        }
+        
+        bool flush = op.type == OP_SCAN ||
+                     (op.type == OP_JZ && !balanced[i]) ||
+                     (op.type == OP_JNZ && !balanced[op.arg]);
+        if (flush && virt != 0) {
+            Op *move = &prog->ops[out++];
+            move->type = OP_MOVE;
+            move->arg = virt;
+            move->offset = 0;
+            move->src = 0;
+            virt = 0;
+        }
+        
+        op.offset += virt;
+        if (op.type == OP_MUL) {
+            op.src += virt;
+        }
+        prog->ops[out++] = op;
+    }
+    
+    prog->count = out;
+}
+
+// Compile-time knowledge of cell values, relative to the data pointer.
+// Cells not in the table are 0 while zero_default holds (the untouched tape
+// at program start) and unknown otherwise. Values are stored unsigned;
+// -1 marks an unknown cell. While the pointer's position on the tape is
+// known, cells off the tape are unknown too, so an access that must fault
+// is never folded away.
+#define MAX_KNOWN_CELLS 256
+
+// Limits of compile-time evaluation in pass_fold_prefix
+#define FOLD_STEP_LIMIT (1 << 21)   // IR operations executed
+#define FOLD_TAPE_CELLS 65536       // cells simulated from the start of the tape
+#define FOLD_MAX_CELLS 1024         // nonzero cells a folded prefix may leave
+
+typedef struct {
+    bool zero_default;
+    bool pointer_known;     // pointer is the data pointer's cell
+    long long pointer;
+    long long cells;        // tape size
+    int count;
+    int offsets[MAX_KNOWN_CELLS];
+    long long values[MAX_KNOWN_CELLS];
+} CellState;
+
+// Look up a cell; returns its value or -1 if unknown
+static long long known_get(const CellState *state, int offset) {
+    if (state->pointer_known &&
+        (state->pointer + offset < 0 || state->pointer + offset >= state->cells)) {
+        return -1;
+    }
+    for (int i = 0; i < state->count; i++) {
+        if (state->offsets[i] == offset) return state->values[i];
+    }
+    return state->zero_default ? 0 : -1;
+}
+
+static void known_set(CellState *state, int offset, long long value) {
+    for (int i = 0; i < state->count; i++) {
+        if (state->offsets[i] == offset) {
+            state->values[i] = value;
+            return;
+        }
+    }
+    if (!state->zero_default && value < 0) return;
+    
+    // Out of room: forget everything, which is always safe
+    if (state->count == MAX_KNOWN_CELLS) {
+        state->zero_default = false;
+        state->count = 0;
+        if (value < 0) return;
+    }
+    state->offsets[state->count] = offset;
+    state->values[state->count++] = value;
+}
+
+static void known_reset(CellState *state) {
+    state->zero_default = false;
+    state->pointer_known = false;
+    state->count = 0;
+}
+
+// Scratch machine for pass_fold_prefix
+typedef struct {
+    uint32_t *tape;
+    size_t cells;           // simulated window, starting at the first cell
+    size_t pointer;
+    size_t nonzero;         // cells of the window that are not 0
+} FoldState;
+
+static void fold_store(FoldState *s, size_t cell, uint32_t value) {
+    s->nonzero += (size_t)(value != 0) - (size_t)(s->tape[cell] != 0);
+    s->tape[cell] = value;
+}
+
+// Run the program from its start on the scratch tape until it reads input,
+// leaves the window, runs out of steps, ends, or reaches top-level
+// operation `stop`. Output is appended to the data pool when `emit` is set.
+// Returns the last top-level operation index at which the state was small
+// enough to fold, or prog->count if the whole program ran.
+static size_t fold_run(Program *prog, FoldState *s, size_t stop, bool emit) {
+    uint32_t mask = (uint32_t)cell_mask(prog);
+    size_t last = 0;
+    size_t steps = 0;
+    int depth = 0;
+    size_t i = 0;
+    
+    while (i < prog->count) {
+        if (depth == 0) {
+            if (s->nonzero <= FOLD_MAX_CELLS) last = i;
+            if (i == stop) return last;
+        }
+        if (++steps > FOLD_STEP_LIMIT) return last;
+        
+        const Op *op = &prog->ops[i];
+        long long cell = (long long)s->pointer + op->offset;
+        long long src = (long long)s->pointer + op->src;
+        if (cell < 0 || cell >= (long long)s->cells) return last;
+        uint32_t *value = &s->tape[cell];
+        
+        switch (op->type) {
+            case OP_ADD:
+                fold_store(s, (size_t)cell, (*value + (uint32_t)op->arg) & mask);
+                break;
+                
+            case OP_MOVE:
+                cell = (long long)s->pointer + op->arg;
+                if (cell < 0 || cell >= (long long)s->cells) return last;
+                s->pointer = (size_t)cell;
+                break;
+                
+            case OP_OUT:
+                if (emit) push_data(prog, (char)*value);
+                break;
+                
+            case OP_IN:
+                return last;
+                
+            case OP_JZ:
+                if (*value == 0) {
+                    i = (size_t)op->arg + 1;
+                    continue;
+                }
+                depth++;
+                break;
+                
+            case OP_JNZ:
+                if (*value != 0) {
+                    i = (size_t)op->arg + 1;
+                    continue;
+                }
+                depth--;
+                break;
+                
+            case OP_CLEAR:
+                fold_store(s, (size_t)cell, 0);
+                break;
+                
+            case OP_MUL:
+                if (src < 0 || src >= (long long)s->cells) return last;
+                fold_store(s, (size_t)cell, (*value + (uint32_t)op->arg * s->tape[src]) & mask);
+                break;
+                
+            case OP_PRINT:
+                for (int k = 0; emit && k < op->arg; k++) {
+                    push_data(prog, prog->data[op->src + k]);
+                }
+                break;
+                
+            case OP_SCAN:
+                for (cell = (long long)s->pointer; s->tape[cell] != 0; ) {
+                    cell += op->arg;
+                    if (cell < 0 || cell >= (long long)s->cells) return last;
+                    if (++steps > FOLD_STEP_LIMIT) return last;
+                }
+                s->pointer = (size_t)cell;
+                break;
+        }
+        i++;
+    }
+    return prog->count;
+}
+
+// Pass: execute the start of the program at compile time. The tape starts
+// out all zero, so everything up to the first ',' is determined; the longest
+// prefix that finishes within the step limit is replaced by a constant
+// print of its output, stores of the cells it left nonzero and a move to
+// where it left the pointer. Only top-level stopping points are used, so the
+// rest of the program runs unchanged.
+static void pass_fold_prefix(Program *prog) {
+    FoldState s;
+    s.cells = prog->tape_size < FOLD_TAPE_CELLS ? prog->tape_size : FOLD_TAPE_CELLS;
+    s.tape = arena_alloc(prog->arena, sizeof(uint32_t) * s.cells);
+    memset(s.tape, 0, sizeof(uint32_t) * s.cells);
+    s.pointer = 0;
+    s.nonzero = 0;
+    
+    size_t stop = fold_run(prog, &s, SIZE_MAX, false);
+    if (stop == 0) {
+        return;
+    }
+    
+    // Run again up to the chosen point, this time keeping the output
+    memset(s.tape, 0, sizeof(uint32_t) * s.cells);
+    s.pointer = 0;
+    s.nonzero = 0;
+    size_t data_start = prog->data_length;
+    fold_run(prog, &s, stop, true);
+    size_t printed = prog->data_length - data_start;
+    
+    // Nothing but --dump-tape can observe the tape once the program has ended
+    bool resumes = stop < prog->count || prog->dump_tape;
+    size_t rest = prog->count - stop;
+    size_t capacity = 0;
+    Op *ops = grow_array(prog->arena, NULL, &capacity, s.nonzero + rest + 2, sizeof(Op));
+    size_t n = 0;
+    
+    if (printed) {
+        ops[n++] = (Op){ OP_PRINT, (int)printed, 0, (int)data_start };
+    }
+    for (size_t cell = 0; resumes && cell < s.cells; cell++) {
+        if (s.tape[cell]) {
+            ops[n++] = (Op){ OP_ADD, wrap_cell(prog, s.tape[cell]), (int)cell, 0 };
+        }
+    }
+    if (resumes && s.pointer) {
+        ops[n++] = (Op){ OP_MOVE, (int)s.pointer, 0, 0 };
+    }
+    memcpy(ops + n, prog->ops + stop, sizeof(Op) * rest);
+    
+    prog->ops = ops;
+    prog->count = n + rest;
+    prog->capacity = capacity;
+}
+
+// Pass: propagate known cell values. Loops entered with a zero cell and
+// operations that cannot change anything are deleted, '.' of cells with a
+// known value becomes OP_PRINT, and prints that are only separated by tape
+// arithmetic are coalesced into one blob.
+static void pass_const_output(Program *prog) {
+    CellState state = {
+        .zero_default = true, .pointer_known = true, .pointer = 0,
+        .cells = (long long)prog->tape_size, .count = 0
+    };
+    long long mask = cell_mask(prog);
+    size_t out = 0;
+    size_t last_print = SIZE_MAX;   // coalescing target in the current run
+    
+    for (size_t i = 0; i < prog->count; i++) {
+        Op op = prog->ops[i];
+        long long value;
+        
+        switch (op.type) {
+            case OP_ADD:
+                value = known_get(&state, op.offset);
+                known_set(&state, op.offset, value < 0 ? -1 : (value + op.arg) & mask);
+                break;
+                
+            case OP_CLEAR:
+                if (known_get(&state, op.offset) == 0) continue;
+                known_set(&state, op.offset, 0);
+                break;
+                
+            case OP_MUL: {
+                long long src = known_get(&state, op.src);
+                if (src == 0) continue;
+                value = known_get(&state, op.offset);
+                known_set(&state, op.offset, src < 0 || value < 0 ? -1 :
+                          (value + op.arg * src) & mask);
+                break;
+            }
+                
+            case OP_MOVE:
+                for (int k = 0; k < state.count; k++) {
+                    state.offsets[k] -= op.arg;
+                }
+                state.pointer += op.arg;
+                break;
+                
+            case OP_OUT:
+                value = known_get(&state, op.offset);
+                if (value >= 0) {
+                    if (last_print != SIZE_MAX) {
+                        push_data(prog, (char)(value & 0xff));
+                        prog->ops[last_print].arg++;
+                        continue;
+                    }
+                    op.type = OP_PRINT;
+                    op.arg = 1;
+                    op.src = (int)prog->data_length;
+                    push_data(prog, (char)(value & 0xff));
+                    last_print = out;
+                    break;
+                }
+                last_print = SIZE_MAX;
+                break;
+                
+            case OP_IN:
+                known_set(&state, op.offset, -1);
+                last_print = SIZE_MAX;
+                break;
+                
+            case OP_JZ:
+                // A loop entered with a zero cell never runs
+                if (known_get(&state, op.offset) == 0) {
+                    prog->dead_loops++;
+                    i = (size_t)op.arg;
+                    continue;
+                }
+                known_reset(&state);
+                last_print = SIZE_MAX;
+                break;
+                
+            case OP_JNZ:
+                // Falling out of a loop means the tested cell is zero
+                known_reset(&state);
+                known_set(&state, op.offset, 0);
+                last_print = SIZE_MAX;
+                break;
+                
+            case OP_SCAN:
+                if (known_get(&state, 0) == 0) {
+                    prog->dead_loops++;
+                    continue;
+                }
+                known_reset(&state);
+                known_set(&state, 0, 0);
+                last_print = SIZE_MAX;
+                break;
+                
+            case OP_PRINT:
+                break;
+        }
+        
+        prog->ops[out++] = op;
+    }
+    
+    prog->count = out;
+}
+
+// Optimization pipeline, run in order after parsing
+static const Pass passes[] = {
+    pass_combine_runs,
+    pass_scan_loops,
+    pass_mul_loops,
+    pass_fold_offsets,
+    pass_fold_prefix,
+    pass_const_output,
+};
+
+static const char *pass_names[] = {
+    "combine_runs", "scan_loops", "mul_loops", "fold_offsets", "fold_prefix",
+    "const_output"
+};
+
+// Lowest -O level each pass runs at
+static const int pass_levels[] = { 1, 1, 1, 2, 2, 2 };
+
+// Monotonic wall-clock time in milliseconds
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+// Record a phase that began at `start` when statistics are being gathered
+static void record_phase(Compiler *c, const char *name, double start, size_t before, size_t after) {
+    bfc_stats *stats = c->stats;
+    if (!stats || stats->phase_count == BFC_MAX_PHASES) {
+        return;
+    }
+    bfc_phase_stats *phase = &stats->phases[stats->phase_count++];
+    phase->name = name;
+    phase->ms = now_ms() - start;
+    phase->ops_before = before;
+    phase->ops_after = after;
+}
+
+static void optimize(Compiler *c, Program *prog) {
+    for (size_t i = 0; i < sizeof(passes) / sizeof(passes[0]); i++) {
+        if (c->options.opt_level < pass_levels[i]) {
+            continue;
+        }
+        double start = now_ms();
+        size_t before = prog->count;
+        passes[i](prog);
+        link_jumps(c, prog);
+        record_phase(c, pass_names[i], start, before, prog->count);
+    }
+}
+
+// Number of loops left in the program
+static size_t count_loops(const Program *prog) {
+    size_t count = 0;
+    for (size_t i = 0; i < prog->count; i++) {
+        count += prog->ops[i].type == OP_JZ;
+    }
+    return count;
+}
+    
+// Find the loops that survived optimization in the source. Loops are taken
+// in IR order, which is the order of their '[', and numbered like the labels
+// compile_instruction gives them.
+static void locate_loops(const Program *prog, const Source *src, ProfileLoop *loops) {
+    size_t pos = 0;
+    int bracket = 0;
+    int label = 0;
+    int line = 1;
+    int column = 1;
+    ProfileLoop *loop = loops;
+    for (size_t i = 0; i < prog->count; i++) {
+        const Op *op = &prog->ops[i];
+        if (op->type == OP_SCAN) {
+            label++;
+        }
+        if (op->type != OP_JZ) {
+            continue;
+        }
+        for (;;) {
+            char ch = src->code[pos++];
+            if ((ch == '[' || ch == ']') && bracket++ == op->src) break;
+            if (ch == '\n') {
+                line++;
+                column = 1;
+            } else {
+                column++;
+            }
+        }
+        loop->label = label++;
+        loop->line = line;
+        loop->column = column++;
+        loop->entries = 0;
+        loop->iterations = 0;
+        loop++;
+    }
+}
+
+static void build_profile(Compiler *c, const Program *prog, const Source *src) {
+    c->profile_count = count_loops(prog);
+    c->profile = arena_alloc(&c->arena, sizeof(ProfileLoop) * (c->profile_count + 1));
+    locate_loops(prog, src, c->profile);
+}
+
+// JSON string literal
+static void buffer_json_string(Buffer *b, const char *s) {
+    static const char hex[] = "0123456789abcdef";
+    buffer_char(b, '"');
+    for (; *s; s++) {
+        unsigned char ch = (unsigned char)*s;
+        if (ch == '"' || ch == '\\') {
+            buffer_char(b, '\\');
+            buffer_char(b, (char)ch);
+        } else if (ch < 32) {
+            buffer_str(b, "\\u00");
+            buffer_char(b, hex[ch >> 4]);
+            buffer_char(b, hex[ch & 15]);
+        } else {
+            buffer_char(b, (char)ch);
+        }
+    }
+    buffer_char(b, '"');
+}
+
+// The profile is JSON with one record per loop:
+//   {"source":"prog.bf","loops":[
+//   {"label":3,"line":12,"column":5,"entries":1,"iterations":4000},
+//   ...
+//   ]}
+// Everything but the two counts is known at compile time, so generated code
+// only has to print numbers between constant strings.
+static const char profile_counts_joint[] = ",\"iterations\":";
+static const char profile_footer[] = "\n]}\n";
+
+static void profile_header(Buffer *b, const char *name) {
+    buffer_str(b, "{\"source\":");
+    buffer_json_string(b, name);
+    buffer_str(b, ",\"loops\":[");
+}
+
+// Record of loop k up to its entry count
+static void profile_prefix(Buffer *b, const Compiler *c, size_t k) {
+    const ProfileLoop *loop = &c->profile[k];
+    buffer_str(b, k == 0 ? "\n{\"label\":" : ",\n{\"label\":");
+    buffer_int(b, loop->label);
+    buffer_str(b, ",\"line\":");
+    buffer_int(b, loop->line);
+    buffer_str(b, ",\"column\":");
+    buffer_int(b, loop->column);
+    buffer_str(b, ",\"entries\":");
+}
+
+// Write the counts gathered by the interpreter
+static void write_profile(Compiler *c, const char *name) {
+    Buffer b = { &c->arena, NULL, 0, 0 };
+    profile_header(&b, name);
+    for (size_t k = 0; k < c->profile_count; k++) {
+        profile_prefix(&b, c, k);
+        buffer_int(&b, (long long)c->profile[k].entries);
+        buffer_str(&b, profile_counts_joint);
+        buffer_int(&b, (long long)c->profile[k].iterations);
+        buffer_char(&b, '}');
+    }
+    buffer_str(&b, profile_footer);
+    
+    FILE *f = fopen(c->options.profile, "w");
+    bool ok = f && fwrite(b.bytes, 1, b.size, f) == b.size;
+    if (f && fclose(f) != 0) {
+        ok = false;
+    }
+    if (!ok) {
+        fail(BFC_ERR_IO, "Could not write profile: %s", c->options.profile);
+    }
+}
+
+static const char profile_error[] = "bf: could not write the profile\n";
+
+// Emit bf_profile_dump, called on the way out: stdout is pointed at the
+// profile file while the records go through the output buffer, then put
+// back. Loop k is printed from the k-th prefix string, the k-th pair of
+// counters and the constant pieces between them.
+static void emit_profile(Compiler *c, const char *name) {
+    Asm *a = c->as;
+    int *rt = c->runtime;
+    int path = asm_new_label(a, "bf_profile_path", -1);
+    int header = asm_new_label(a, "bf_profile_header", -1);
+    int prefixes = asm_new_label(a, "bf_profile_prefixes", -1);
+    int lengths = asm_new_label(a, "bf_profile_lengths", -1);
+    int joint = asm_new_label(a, "bf_profile_joint", -1);
+    int footer = asm_new_label(a, "bf_profile_footer", -1);
+    int error = asm_new_label(a, "bf_profile_error", -1);
+    int next = asm_new_label(a, "bf_profile_next", -1);
+    int done = asm_new_label(a, "bf_profile_done", -1);
+    int failed = asm_new_label(a, "bf_profile_failed", -1);
+    int digit = asm_new_label(a, "bf_print_digit", -1);
+    Buffer text = { &c->arena, NULL, 0, 0 };
+    profile_header(&text, name);
+    
+    asm_bind(a, rt[RT_PROFILE_DUMP]);
+    asm_op(a, I_MOV, 8, imm(1), reg(RDI));
+    emit_syscall(c, 32, "sys_dup");
+    asm_note(a, "saved stdout");
+    asm_op1(a, I_PUSH, 8, reg(RAX));
+    asm_op(a, I_LEA, 8, rip(path, 0), reg(RDI));
+    asm_note(a, "O_WRONLY | O_CREAT | O_TRUNC");
+    asm_op(a, I_MOV, 8, imm(0x241), reg(RSI));
+    asm_op(a, I_MOV, 8, imm(0644), reg(RDX));
+    emit_syscall(c, 2, "sys_open");
+    asm_op(a, I_CMP, 8, imm(-4095), reg(RAX));
+    asm_jcc(a, CC_AE, failed);
+    asm_op(a, I_MOV, 8, reg(RAX), reg(RDI));
+    asm_op(a, I_MOV, 8, imm(1), reg(RSI));
+    emit_syscall(c, 33, "sys_dup2");
+    emit_syscall(c, 3, "sys_close");
+    asm_op(a, I_LEA, 8, rip(header, 0), reg(RSI));
+    asm_op(a, I_MOV, 8, imm((long long)text.size), reg(RDX));
+    asm_call(a, rt[RT_WRITE]);
+    
+    asm_raw(a, "    # Prefix strings in r12, their lengths in r15, counters in r14\n");
+    asm_op(a, I_LEA, 8, rip(prefixes, 0), reg(R12));
+    asm_op(a, I_LEA, 8, rip(lengths, 0), reg(R15));
+    asm_op(a, I_LEA, 8, rip(rt[RT_PROFILE], 0), reg(R14));
+    asm_bind(a, next);
+    asm_op(a, I_LEA, 8, rip(rt[RT_PROFILE], 16 * (long long)c->profile_count), reg(RAX));
+    asm_op(a, I_CMP, 8, reg(RAX), reg(R14));
+    asm_jcc(a, CC_AE, done);
+    asm_op(a, I_MOV, 8, reg(R12), reg(RSI));
+    asm_op(a, I_MOV, 8, mem(R15, 0), reg(RDX));
+    asm_op(a, I_ADD, 8, reg(RDX), reg(R12));
+    asm_call(a, rt[RT_WRITE]);
+    asm_op(a, I_MOV, 8, mem(R14, 0), reg(RAX));
+    asm_call(a, rt[RT_PRINT_NUMBER]);
+    asm_op(a, I_LEA, 8, rip(joint, 0), reg(RSI));
+    asm_op(a, I_MOV, 8, imm(sizeof(profile_counts_joint) - 1), reg(RDX));
+    asm_call(a, rt[RT_WRITE]);
+    asm_op(a, I_MOV, 8, mem(R14, 8), reg(RAX));
+    asm_call(a, rt[RT_PRINT_NUMBER]);
+    asm_op(a, I_MOV, 4, imm('}'), reg(RAX));
+    asm_call(a, rt[RT_PUTCHAR]);
+    asm_op(a, I_ADD, 8, imm(16), reg(R14));
+    asm_op(a, I_ADD, 8, imm(8), reg(R15));
+    asm_jmp(a, next);
+    
+    asm_bind(a, done);
+    asm_op(a, I_LEA, 8, rip(footer, 0), reg(RSI));
+    asm_op(a, I_MOV, 8, imm(sizeof(profile_footer) - 1), reg(RDX));
+    asm_call(a, rt[RT_WRITE]);
+    asm_call(a, rt[RT_FLUSH]);
+    asm_op1(a, I_POP, 8, reg(RDI));
+    asm_op(a, I_MOV, 8, imm(1), reg(RSI));
+    emit_syscall(c, 33, "sys_dup2");
+    emit_syscall(c, 3, "sys_close");
+    asm_op0(a, I_RET);
+    asm_raw(a, "\n");
+    
+    asm_bind(a, failed);
+    asm_note(a, "stderr");
+    asm_op(a, I_MOV, 8, imm(2), reg(RDI));
+    asm_op(a, I_LEA, 8, rip(error, 0), reg(RSI));
+    asm_op(a, I_MOV, 8, imm(sizeof(profile_error) - 1), reg(RDX));
+    emit_syscall(c, 1, "sys_write");
+    asm_jmp(a, rt[RT_WRITE_ERROR]);
+    asm_raw(a, "\n");
+    
+    // bf_print_number: write %rax in decimal, digits built backwards on
+    // the stack
+    asm_bind(a, rt[RT_PRINT_NUMBER]);
+    asm_op(a, I_SUB, 8, imm(32), reg(RSP));
+    asm_op(a, I_LEA, 8, mem(RSP, 32), reg(RSI));
+    asm_op(a, I_MOV, 8, imm(10), reg(RCX));
+    asm_bind(a, digit);
+    asm_op(a, I_XOR, 4, reg(RDX), reg(RDX));
+    asm_op1(a, I_DIV, 8, reg(RCX));
+    asm_op(a, I_ADD, 1, imm('0'), reg(RDX));
+    asm_op1(a, I_DEC, 8, reg(RSI));
+    asm_op(a, I_MOV, 1, reg(RDX), mem(RSI, 0));
+    asm_op(a, I_TEST, 8, reg(RAX), reg(RAX));
+    asm_jcc(a, CC_NE, digit);
+    asm_op(a, I_LEA, 8, mem(RSP, 32), reg(RDX));
+    asm_op(a, I_SUB, 8, reg(RSI), reg(RDX));
+    asm_call(a, rt[RT_WRITE]);
+    asm_op(a, I_ADD, 8, imm(32), reg(RSP));
+    asm_op0(a, I_RET);
+    asm_raw(a, "\n");
+    
+    asm_section(a, SEC_RODATA);
+    asm_bind(a, path);
+    asm_ascii(a, c->options.profile, strlen(c->options.profile) + 1);
+    asm_bind(a, header);
+    asm_ascii(a, text.bytes, text.size);
+    asm_bind(a, joint);
+    asm_ascii(a, profile_counts_joint, sizeof(profile_counts_joint) - 1);
+    asm_bind(a, footer);
+    asm_ascii(a, profile_footer, sizeof(profile_footer) - 1);
+    asm_bind(a, error);
+    asm_ascii(a, profile_error, sizeof(profile_error) - 1);
+    
+    size_t *sizes = arena_alloc(&c->arena, sizeof(size_t) * (c->profile_count + 1));
+    asm_bind(a, prefixes);
+    for (size_t k = 0; k < c->profile_count; k++) {
+        text.size = 0;
+        profile_prefix(&text, c, k);
+        asm_ascii(a, text.bytes, text.size);
+        sizes[k] = text.size;
+    }
+    asm_align(a, 8);
+    asm_bind(a, lengths);
+    for (size_t k = 0; k < c->profile_count; k++) {
+        asm_quad(a, (long long)sizes[k]);
+    }
+    asm_section(a, SEC_TEXT);
+}
+
+// Profile-guided code generation. A loop is hot when its body ran at least
+// HOT_ITERATIONS times and made up at least 1/HOT_SHARE of all iterations
+// in the profile. Hot loops get an aligned loop_start; hot innermost loops
+// that average at most UNROLL_TRIPS iterations per entry have their body
+// repeated up to MAX_UNROLL times, so most entries leave without a jump back.
+#define HOT_ITERATIONS 1024
+#define HOT_SHARE 100
+#define UNROLL_TRIPS 8
+#define MAX_UNROLL 4
+#define UNROLL_BODY_OPS 16
+#define LOOP_ALIGN 16
+
+static const char *skip_space(const char *p) {
+    while (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r') p++;
+    return p;
+}
+
+static bool key_is(const char *key, size_t length, const char *name) {
+    return strlen(name) == length && memcmp(key, name, length) == 0;
+}
+
+// Read the records of a profile written by --profile. Only the position and
+// the counts of each loop are used; the label numbers belong to the build
+// that wrote it.
+static size_t read_profile(Compiler *c, ProfileLoop **out) {
+    const char *path = c->options.use_profile;
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        fail(BFC_ERR_IO, "Could not read profile: %s", path);
+    }
+    Buffer text = { &c->arena, NULL, 0, 0 };
+    size_t n;
+    do {
+        n = fread(buffer_reserve(&text, 4096), 1, 4096, f);
+        text.size += n;
+    } while (n > 0);
+    bool ok = !ferror(f);
+    fclose(f);
+    if (!ok) {
+        fail(BFC_ERR_IO, "Could not read profile: %s", path);
+    }
+    buffer_char(&text, '\0');
+    
+    ProfileLoop *loops = NULL;
+    size_t count = 0;
+    size_t capacity = 0;
+    const char *p = strstr(text.bytes, "\"loops\"");
+    p = p ? strchr(p, '[') : NULL;
+    if (!p) {
+        fail(BFC_ERR_OPTIONS, "Invalid profile: %s", path);
+    }
+    for (p = skip_space(p + 1); *p != ']'; p = skip_space(p)) {
+        if (count > 0 && *p++ != ',') {
+            fail(BFC_ERR_OPTIONS, "Invalid profile: %s", path);
+        }
+        p = skip_space(p);
+        if (*p++ != '{') {
+            fail(BFC_ERR_OPTIONS, "Invalid profile: %s", path);
+        }
+        loops = grow_array(&c->arena, loops, &capacity, count + 1, sizeof(ProfileLoop));
+        ProfileLoop *loop = &loops[count++];
+        memset(loop, 0, sizeof(ProfileLoop));
+        
+        // "key":number pairs up to the closing brace
+        for (bool first = true; *(p = skip_space(p)) != '}'; first = false) {
+            if (!first && *p++ != ',') {
+                fail(BFC_ERR_OPTIONS, "Invalid profile: %s", path);
+            }
+            p = skip_space(p);
+            const char *key = p + 1;
+            const char *key_end = *p == '"' ? strchr(key, '"') : NULL;
+            if (!key_end) {
+                fail(BFC_ERR_OPTIONS, "Invalid profile: %s", path);
+            }
+            p = skip_space(key_end + 1);
+            if (*p++ != ':') {
+                fail(BFC_ERR_OPTIONS, "Invalid profile: %s", path);
+            }
+            p = skip_space(p);
+            char *end;
+            unsigned long long value = strtoull(p, &end, 10);
+            if (*p < '0' || *p > '9') {
+                fail(BFC_ERR_OPTIONS, "Invalid profile: %s", path);
+            }
+            p = end;
+            
+            size_t length = (size_t)(key_end - key);
+            if (key_is(key, length, "line") && value <= INT_MAX) {
+                loop->line = (int)value;
+            } else if (key_is(key, length, "column") && value <= INT_MAX) {
+                loop->column = (int)value;
+            } else if (key_is(key, length, "entries")) {
+                loop->entries = value;
+            } else if (key_is(key, length, "iterations")) {
+                loop->iterations = value;
+            }
+        }
+        p++;
+    }
+    
+    *out = loops;
+    return count;
+}
+
+static int compare_positions(const void *a, const void *b) {
+    const ProfileLoop *x = a;
+    const ProfileLoop *y = b;
+    if (x->line != y->line) {
+        return x->line < y->line ? -1 : 1;
+    }
+    return (x->column > y->column) - (x->column < y->column);
+}
+
+// An innermost loop whose body can be emitted more than once: copies must
+// not define labels or strings of their own
+static bool can_unroll(const Program *prog, size_t start) {
+    size_t end = (size_t)prog->ops[start].arg;
+    if (end - start - 1 > UNROLL_BODY_OPS) {
+        return false;
+    }
+    for (size_t i = start + 1; i < end; i++) {
+        OpType type = prog->ops[i].type;
+        if (type == OP_JZ || type == OP_SCAN || type == OP_PRINT) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Decide how to emit each loop from a recorded profile. Loops are matched to
+// the records by the position of their '[', so a profile stays usable for
+// builds with other options, where other loops survive optimization; loops
+// without a record are emitted as usual.
+static void plan_loops(Compiler *c, const Program *prog, const Source *src) {
+    ProfileLoop *records;
+    size_t record_count = read_profile(c, &records);
+    if (record_count > 0) {
+        qsort(records, record_count, sizeof(ProfileLoop), compare_positions);
+    }
+    uint64_t total = 0;
+    for (size_t k = 0; k < record_count; k++) {
+        total += records[k].iterations;
+    }
+    
+    ProfileLoop *loops = arena_alloc(&c->arena, sizeof(ProfileLoop) * (count_loops(prog) + 1));
+    locate_loops(prog, src, loops);
+    c->plans = arena_alloc(&c->arena, sizeof(LoopPlan) * prog->count);
+    memset(c->plans, 0, sizeof(LoopPlan) * prog->count);
+    
+    const ProfileLoop *loop = loops;
+    for (size_t i = 0; i < prog->count; i++) {
+        if (prog->ops[i].type != OP_JZ) {
+            continue;
+        }
+        const ProfileLoop *here = loop++;
+        const ProfileLoop *found = record_count == 0 ? NULL :
+            bsearch(here, records, record_count, sizeof(ProfileLoop), compare_positions);
+        if (!found || found->entries == 0 || found->iterations < HOT_ITERATIONS ||
+            found->iterations < total / HOT_SHARE) {
+            continue;
+        }
+        
+        LoopPlan *plan = &c->plans[i];
+        uint64_t trips = (found->iterations + found->entries - 1) / found->entries;
+        plan->align = true;
+        if (trips >= 2 && trips <= UNROLL_TRIPS && can_unroll(prog, i)) {
+            plan->unroll = trips < MAX_UNROLL ? (int)trips : MAX_UNROLL;
+        }
+    }
+}
+
+// Cells reached by a block, relative to the data pointer; empty while
+// low > high
+typedef struct {
+    long long low;
+    long long high;
+} CellRange;
+
+static const CellRange no_cells = { 1, 0 };
+
+static bool range_empty(CellRange r) {
+    return r.low > r.high;
+}
+
+static void range_add(CellRange *r, long long cell) {
+    if (range_empty(*r)) {
+        r->low = r->high = cell;
+    } else if (cell < r->low) {
+        r->low = cell;
+    } else if (cell > r->high) {
+        r->high = cell;
+    }
+}
+
+static bool range_covers(CellRange outer, CellRange inner) {
+    return !range_empty(outer) && outer.low <= inner.low && inner.high <= outer.high;
+}
+
+// Smallest range holding both
+static CellRange range_join(CellRange a, CellRange b) {
+    if (range_empty(a)) return b;
+    if (range_empty(b)) return a;
+    return (CellRange){ a.low < b.low ? a.low : b.low, a.high > b.high ? a.high : b.high };
+}
+
+static CellRange range_meet(CellRange a, CellRange b) {
+    if (range_empty(a) || range_empty(b)) return no_cells;
+    return (CellRange){ a.low > b.low ? a.low : b.low, a.high < b.high ? a.high : b.high };
+}
+
+// The same cells seen from a pointer `delta` cells further on
+static CellRange range_shift(CellRange r, long long delta) {
+    return range_empty(r) ? r : (CellRange){ r.low - delta, r.high - delta };
+}
+
+// Bracket that opens the block whose first operation is `start`: the '[' of
+// a loop body, or the ']' of the loop or scan before it. -1 at the start.
+static int block_bracket(const Program *prog, const Source *src, size_t start) {
+    if (start == 0) {
+        return -1;
+    }
+    const Op *op = &prog->ops[start - 1];
+    switch (op->type) {
+        case OP_JZ: return op->src;
+        case OP_JNZ: return src->brackets[prog->ops[op->arg].src];
+        case OP_SCAN: return src->brackets[op->src];
+        default: return block_bracket(prog, src, start - 1);
+    }
+}
+
+// Position in the source, moved forward bracket by bracket
+typedef struct {
+    size_t pos;
+    size_t line;
+    size_t column;
+    int seen;               // brackets before pos
+} SourceCursor;
+
+// Move the cursor to bracket number `bracket`, at or after the cursor
+static void cursor_to_bracket(SourceCursor *cur, const Source *src, int bracket) {
+    for (;;) {
+        char ch = src->code[cur->pos];
+        if (ch == '[' || ch == ']') {
+            if (cur->seen == bracket) return;
+            cur->seen++;
+        }
+        if (ch == '\n') {
+            cur->line++;
+            cur->column = 1;
+        } else {
+            cur->column++;
+        }
+        cur->pos++;
+    }
+}
+
+// Message of a failed --safe check in the block opened by `bracket`
+static int bounds_message(char *buf, size_t size, SourceCursor *cur, const Source *src, int bracket) {
+    if (bracket < 0) {
+        return snprintf(buf, size, "bf: tape access out of bounds at the start of %s\n", src->name);
+    }
+    cursor_to_bracket(cur, src, bracket);
+    return snprintf(buf, size, "bf: tape access out of bounds in the block after %s:%zu:%zu\n",
+                    src->name, cur->line, cur->column);
+}
+
+// --safe: plan one bounds check per block of straight-line code. A block
+// starts the program or a loop body, or follows a loop or scan, and ends
+// with the next loop test or scan; its check covers every cell it touches.
+// A check is dropped when its cells are already known to be on the tape:
+// the tape is contiguous, so so is everything between two checked cells.
+// The body of an innermost loop that does not move the pointer is checked
+// once when the loop is entered, not on every iteration.
+static void plan_checks(Compiler *c, Program *prog) {
+    const Op *ops = prog->ops;
+    BoundsCheck *checks = arena_alloc(&c->arena, sizeof(BoundsCheck) * (prog->count + 1));
+    memset(checks, 0, sizeof(BoundsCheck) * (prog->count + 1));
+    CellRange *at_loop = arena_alloc(&c->arena, sizeof(CellRange) * (prog->count + 1));
+    CellRange known = { 0, (long long)c->options.tape_size - 1 };
+    
+    for (size_t start = 0; ; ) {
+        CellRange cells = no_cells;
+        long long delta = 0;
+        size_t end = start;
+        for (; end < prog->count; end++) {
+            const Op *op = &ops[end];
+            if (op->type == OP_MOVE) {
+                delta += op->arg;
+                continue;
+            }
+            if (op->type == OP_PRINT) {
+                continue;
+            }
+            range_add(&cells, delta + op->offset);
+            if (op->type == OP_MUL) {
+                range_add(&cells, delta + op->src);
+            }
+            if (op->type == OP_JZ || op->type == OP_JNZ || op->type == OP_SCAN) {
+                break;
+            }
+        }
+        
+        BoundsCheck *check = &checks[start];
+        check->hoisted = start > 0 && ops[start - 1].type == OP_JZ &&
+                         end == (size_t)ops[start - 1].arg && delta == 0;
+        if (check->hoisted) {
+            known = at_loop[start - 1];
+        }
+        check->needed = !range_empty(cells) && !range_covers(known, cells);
+        check->low = cells.low;
+        check->high = cells.high;
+        check->bracket = block_bracket(prog, c->source, start);
+        check->label = -1;
+        if (end == prog->count) {
+            break;
+        }
+        
+        // Cells known to be on the tape at the block's last operation
+        CellRange proven = range_shift(check->needed ? range_join(known, cells) : known, delta);
+        switch (ops[end].type) {
+            case OP_JZ:
+                at_loop[end] = proven;
+                known = no_cells;
+                break;
+            case OP_JNZ:
+                // Reached from the last block of the body or the loop test
+                known = range_meet(proven, at_loop[ops[end].arg]);
+                break;
+            default:
+                known = no_cells;
+                break;
+        }
+        start = end + 1;
+    }
+    
+    c->checks = checks;
+}
+
+// --safe: test the cells of the block starting at IR index `index`. One
+// unsigned compare of the lowest cell's distance from the tape base catches
+// both ends of the tape.
+static void emit_check(Compiler *c, size_t index) {
+    if (!c->checks || !c->checks[index].needed) {
+        return;
+    }
+    BoundsCheck *check = &c->checks[index];
+    Asm *a = c->as;
+    int size = cell_width(c);
+    long long limit = ((long long)c->options.tape_size - 1 - (check->high - check->low)) * size;
+    long long low = check->low * size;
+    check->label = asm_new_label(a, "bounds_error", (int)index);
+    
+    if (limit < 0) {
+        asm_note(a, "block wider than the tape");
+        asm_jmp(a, check->label);
+        return;
+    }
+    asm_note(a, "bounds check");
+    if (low >= INT32_MIN && low <= INT32_MAX) {
+        asm_op(a, I_LEA, 8, mem(R12, low), reg(RAX));
+    } else {
+        asm_op(a, I_MOV, 8, imm(low), reg(RAX));
+        asm_op(a, I_ADD, 8, reg(R12), reg(RAX));
+    }
+    asm_op(a, I_SUB, 8, rip(c->runtime[RT_TAPE_BASE], 0), reg(RAX));
+    if (limit <= INT32_MAX) {
+        asm_op(a, I_CMP, 8, imm(limit), reg(RAX));
+    } else {
+        asm_op(a, I_MOV, 8, imm(limit), reg(RCX));
+        asm_op(a, I_CMP, 8, reg(RCX), reg(RAX));
+    }
+    asm_jcc(a, CC_A, check->label);
+}
+
+// --safe: the targets of the checks emitted, each passing its message to
+// bf_bounds_error, which prints it after the pending output and exits
+static void emit_bounds_errors(Compiler *c) {
+    Asm *a = c->as;
+    int *rt = c->runtime;
+    Program *prog = c->program;
+    SourceCursor cursor = { 0, 1, 1, 0 };
+    char message[512];
+    
+    for (size_t i = 0; i <= prog->count; i++) {
+        const BoundsCheck *check = &c->checks[i];
+        if (!check->needed || check->label < 0) {
+            continue;
+        }
+        int length = bounds_message(message, sizeof(message), &cursor, c->source, check->bracket);
+        if (length >= (int)sizeof(message)) {
+            length = (int)sizeof(message) - 1;
+        }
+        int start = (int)prog->data_length;
+        for (int k = 0; k < length; k++) {
+            push_data(prog, message[k]);
+        }
+        int label = asm_new_label(a, "bounds_message", (int)i);
+        push_string(c, label, start, length);
+        
+        asm_bind(a, check->label);
+        asm_op(a, I_LEA, 8, rip(label, 0), reg(RSI));
+        asm_op(a, I_MOV, 8, imm(length), reg(RDX));
+        asm_jmp(a, rt[RT_BOUNDS_ERROR]);
+    }
+    asm_raw(a, "\n");
+    
+    asm_bind(a, rt[RT_BOUNDS_ERROR]);
+    asm_op1(a, I_PUSH, 8, reg(RSI));
+    asm_op1(a, I_PUSH, 8, reg(RDX));
+    asm_call(a, rt[RT_FLUSH]);
+    asm_op1(a, I_POP, 8, reg(RDX));
+    asm_op1(a, I_POP, 8, reg(RSI));
+    asm_note(a, "stderr");
+    asm_op(a, I_MOV, 8, imm(2), reg(RDI));
+    emit_syscall(c, 1, "sys_write");
+    asm_jmp(a, rt[RT_TAPE_FAULT]);
+    asm_raw(a, "\n");
+}
+
+// Interpreter I/O state, buffered like the generated runtime
+typedef struct {
+    uint8_t out[OUTPUT_BUFFER_SIZE];
+    size_t out_length;
+    uint8_t in[INPUT_BUFFER_SIZE];
+    size_t in_position;
+    size_t in_length;
+} Machine;
+
+// Write the output buffer to stdout, retrying short writes
+static void machine_flush(Machine *m) {
+    size_t done = 0;
+    while (done < m->out_length) {
+        ssize_t n = write(1, m->out + done, m->out_length - done);
+        if (n <= 0) {
+            fail(BFC_ERR_RUNTIME, "The program could not write its output");
+        }
+        done += (size_t)n;
+    }
+    m->out_length = 0;
+}
+
+static void machine_write(Machine *m, const char *bytes, size_t count) {
+    while (count > 0) {
+        size_t room = OUTPUT_BUFFER_SIZE - m->out_length;
+        size_t chunk = count < room ? count : room;
+        memcpy(m->out + m->out_length, bytes, chunk);
+        m->out_length += chunk;
+        bytes += chunk;
+        count -= chunk;
+        if (m->out_length == OUTPUT_BUFFER_SIZE) {
+            machine_flush(m);
+        }
+    }
+}
+
+// Next input byte, or -1 at end of input; pending output is flushed
+// before blocking on stdin
+static int machine_read(Machine *m) {
+    if (m->in_position == m->in_length) {
+        machine_flush(m);
+        ssize_t n = read(0, m->in, INPUT_BUFFER_SIZE);
+        if (n <= 0) {
+            return -1;
+        }
+        m->in_position = 0;
+        m->in_length = (size_t)n;
+    }
+    return m->in[m->in_position++];
+}
+
+// Pre-decoded operation: loop targets are resolved to the index to continue
+// at, and `target` holds the handler address for threaded dispatch
+typedef struct {
+    const void *target;
+    int type;           // OpType, or DECODED_HALT after the last operation
+    int arg;
+    int offset;
+    int src;
+} Decoded;
+
+#define DECODED_HALT -1
+
+// Loop operations that also count for --profile; src holds the loop
+#define DECODED_JZ_COUNT (OP_SCAN + 1)
+#define DECODED_JNZ_COUNT (OP_SCAN + 2)
+
+// Added to the type of an operation that accesses cells away from the data
+// pointer; its handler checks them against the tape first
+#define DECODED_CHECKED (OP_SCAN + 3)
+
+// Stop on a tape access out of bounds at IR index `index`; with --safe the
+// message names the block, as in generated code
+static _Noreturn void tape_error_stop(const Compiler *c, Machine *m, size_t index) {
+    machine_flush(m);
+    if (c->options.safe) {
+        const Program *prog = c->program;
+        size_t start = index;
+        while (start > 0 && prog->ops[start - 1].type != OP_JZ &&
+               prog->ops[start - 1].type != OP_JNZ && prog->ops[start - 1].type != OP_SCAN) {
+            start--;
+        }
+        SourceCursor cursor = { 0, 1, 1, 0 };
+        char message[512];
+        bounds_message(message, sizeof(message), &cursor, c->source,
+                       block_bracket(prog, c->source, start));
+        fputs(message, stderr);
+    } else {
+        fputs(tape_error, stderr);
+    }
+    fail(BFC_ERR_RUNTIME, "The program accessed the tape out of bounds");
+}
+
+// --dump-tape: write the cells to stderr in the cell width, little-endian,
+// as the generated code does
+static void dump_cells(const uint32_t *cells, size_t count, int cell_size) {
+    uint8_t bytes[OUTPUT_BUFFER_SIZE];
+    size_t length = 0;
+    for (size_t i = 0; i < count; i++) {
+        for (int k = 0; k < cell_size; k++) {
+            bytes[length++] = (uint8_t)(cells[i] >> (8 * k));
+        }
+        if (length + sizeof(uint32_t) > sizeof(bytes) || i + 1 == count) {
+            fwrite(bytes, 1, length, stderr);
+            length = 0;
+        }
+    }
+}
+
+// Run the optimized IR directly. Cells are kept as 32-bit values reduced to
+// the cell width after every update; the pointer is checked whenever it
+// moves, and the tape has room on both sides for the largest folded offset.
+// With --safe the cells of each block are checked as it is entered, after
+// the loop test or scan before it.
+// Dispatch jumps straight from handler to handler with computed goto where
+// the compiler supports it, and through a switch otherwise.
+static void interpret(Compiler *c, Program *prog) {
+#if defined(__GNUC__)
+    static const void *handlers[] = {
+        [OP_ADD] = &&do_add, [OP_MOVE] = &&do_move, [OP_OUT] = &&do_out,
+        [OP_IN] = &&do_in, [OP_JZ] = &&do_jz, [OP_JNZ] = &&do_jnz,
+        [OP_CLEAR] = &&do_clear, [OP_MUL] = &&do_mul, [OP_PRINT] = &&do_print,
+        [OP_SCAN] = &&do_scan, [DECODED_JZ_COUNT] = &&do_jz_count,
+        [DECODED_JNZ_COUNT] = &&do_jnz_count,
+        [DECODED_CHECKED + OP_ADD] = &&check_add, [DECODED_CHECKED + OP_OUT] = &&check_out,
+        [DECODED_CHECKED + OP_IN] = &&check_in, [DECODED_CHECKED + OP_JZ] = &&check_jz,
+        [DECODED_CHECKED + OP_JNZ] = &&check_jnz, [DECODED_CHECKED + OP_CLEAR] = &&check_clear,
+        [DECODED_CHECKED + OP_MUL] = &&check_mul,
+        [DECODED_CHECKED + DECODED_JZ_COUNT] = &&check_jz_count,
+        [DECODED_CHECKED + DECODED_JNZ_COUNT] = &&check_jnz_count
+    };
+#define DISPATCH() goto *ip->target
+#else
+#define DISPATCH() goto dispatch
+#endif
+    
+    Decoded *code = arena_alloc(&c->arena, sizeof(Decoded) * (prog->count + 1));
+    Machine *m = arena_alloc(&c->arena, sizeof(Machine));
+    m->out_length = 0;
+    m->in_position = 0;
+    m->in_length = 0;
+    ProfileLoop *loops = c->options.profile ? c->profile : NULL;
+    int loop = 0;
+    
+    // Cells from low to high around the pointer were checked earlier in the
+    // current straight-line run; the pointer's own cell always is on the tape
+    long long reach = 0;
+    int low = 0;
+    int high = 0;
+    for (size_t i = 0; i < prog->count; i++) {
+        const Op *op = &prog->ops[i];
+        Decoded *d = &code[i];
+        d->type = op->type;
+        d->arg = op->arg;
+        d->offset = op->offset;
+        d->src = op->src;
+        if (op->type == OP_JZ || op->type == OP_JNZ) {
+            d->arg = op->arg + 1;   // just past the matching bracket
+        }
+        if (loops && op->type == OP_JZ) {
+            d->type = DECODED_JZ_COUNT;
+            d->src = loop++;
+        } else if (loops && op->type == OP_JNZ) {
+            d->type = DECODED_JNZ_COUNT;
+            d->src = code[op->arg].src;
+        }
+        if (op->type == OP_MOVE || op->type == OP_SCAN) {
+            low = high = 0;
+        } else if (op->type != OP_PRINT) {
+            int src = op->type == OP_MUL ? op->src : 0;
+            if (op->offset < low || op->offset > high || src < low || src > high) {
+                d->type += DECODED_CHECKED;
+            }
+            low = op->offset < low ? op->offset : low;
+            low = src < low ? src : low;
+            high = op->offset > high ? op->offset : high;
+            high = src > high ? src : high;
+            if (op->type == OP_JZ || op->type == OP_JNZ) {
+                low = high = 0;
+            }
+        }
+        if (llabs(op->offset) > reach) reach = llabs(op->offset);
+        if (op->type == OP_MUL && llabs(op->src) > reach) reach = llabs(op->src);
+#if defined(__GNUC__)
+        d->target = handlers[d->type];
+#endif
+    }
+    code[prog->count].type = DECODED_HALT;
+#if defined(__GNUC__)
+    code[prog->count].target = &&do_halt;
+#endif
+    
+    size_t cells = c->options.tape_size + 2 * (size_t)reach;
+    size_t bytes = cells * sizeof(uint32_t);
+    uint32_t *base = mmap(NULL, bytes, PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (base == MAP_FAILED) {
+        fail(BFC_ERR_MEMORY, "Could not map %zu bytes for the tape", bytes);
+    }
+    c->mapping = base;
+    c->mapping_size = bytes;
+    
+    uint32_t mask = (uint32_t)cell_mask(prog);
+    uint32_t *first = base + reach;
+    uint32_t *last = first + c->options.tape_size - 1;
+    size_t span = c->options.tape_size - 1;
+    uint32_t *p = first;
+    const Decoded *ip = code;
+    const BoundsCheck *checks = c->checks;
+    
+    // Jumps to the start of a block go through do_check with --safe
+#define BLOCK_DISPATCH() if (checks) goto do_check; DISPATCH()
+    // Moves keep p on the tape. Accesses at an offset go through a check_
+    // handler first, so a program whose moves were folded into offsets
+    // fails as it does at -O0. The margin of `reach` cells keeps p + offset
+    // inside the mapping.
+#define CHECK_CELL(offset) \
+    if ((size_t)(p - first + (offset)) > span) tape_error_stop(c, m, (size_t)(ip - code))
+    BLOCK_DISPATCH();
+    
+#if !defined(__GNUC__)
+dispatch:
+    switch (ip->type) {
+        case OP_ADD: goto do_add;
+        case OP_MOVE: goto do_move;
+        case OP_OUT: goto do_out;
+        case OP_IN: goto do_in;
+        case OP_JZ: goto do_jz;
+        case OP_JNZ: goto do_jnz;
+        case OP_CLEAR: goto do_clear;
+        case OP_MUL: goto do_mul;
+        case OP_PRINT: goto do_print;
+        case OP_SCAN: goto do_scan;
+        case DECODED_JZ_COUNT: goto do_jz_count;
+        case DECODED_JNZ_COUNT: goto do_jnz_count;
+        case DECODED_CHECKED + OP_ADD: goto check_add;
+        case DECODED_CHECKED + OP_OUT: goto check_out;
+        case DECODED_CHECKED + OP_IN: goto check_in;
+        case DECODED_CHECKED + OP_JZ: goto check_jz;
+        case DECODED_CHECKED + OP_JNZ: goto check_jnz;
+        case DECODED_CHECKED + OP_CLEAR: goto check_clear;
+        case DECODED_CHECKED + OP_MUL: goto check_mul;
+        case DECODED_CHECKED + DECODED_JZ_COUNT: goto check_jz_count;
+        case DECODED_CHECKED + DECODED_JNZ_COUNT: goto check_jnz_count;
+        default: goto do_halt;
+    }
+#endif
+    
+check_add:
+    CHECK_CELL(ip->offset);
+do_add:
+    p[ip->offset] = (p[ip->offset] + (uint32_t)ip->arg) & mask;
+    ip++;
+    DISPATCH();
+    
+do_move:
+    p += ip->arg;
+    if (p < first || p > last) tape_error_stop(c, m, (size_t)(ip - code));
+    ip++;
+    DISPATCH();
+    
+check_out:
+    CHECK_CELL(ip->offset);
+do_out:
+    if (m->out_length == OUTPUT_BUFFER_SIZE) machine_flush(m);
+    m->out[m->out_length++] = (uint8_t)p[ip->offset];
+    ip++;
+    DISPATCH();
+    
+check_in:
+    CHECK_CELL(ip->offset);
+do_in: {
+    int ch = machine_read(m);
+    if (ch >= 0) {
+        p[ip->offset] = (uint32_t)ch;
+    } else if (c->options.eof_mode == EOF_ZERO) {
+        p[ip->offset] = 0;
+    } else if (c->options.eof_mode == EOF_MINUS_ONE) {
+        p[ip->offset] = mask;
+    }
+    ip++;
+    DISPATCH();
+}
+    
+check_jz:
+    CHECK_CELL(ip->offset);
+do_jz:
+    ip = p[ip->offset] ? ip + 1 : code + ip->arg;
+    BLOCK_DISPATCH();
+    
+check_jnz:
+    CHECK_CELL(ip->offset);
+do_jnz:
+    ip = p[ip->offset] ? code + ip->arg : ip + 1;
+    BLOCK_DISPATCH();
+    
+check_jz_count:
+    CHECK_CELL(ip->offset);
+do_jz_count:
+    loops[ip->src].entries++;
+    if (p[ip->offset]) {
+        loops[ip->src].iterations++;
+        ip++;
+    } else {
+        ip = code + ip->arg;
+    }
+    BLOCK_DISPATCH();
+    
+check_jnz_count:
+    CHECK_CELL(ip->offset);
+do_jnz_count:
+    if (p[ip->offset]) {
+        loops[ip->src].iterations++;
+        ip = code + ip->arg;
+    } else {
+        ip++;
+    }
+    BLOCK_DISPATCH();
+    
+check_clear:
+    CHECK_CELL(ip->offset);
+do_clear:
+    p[ip->offset] = 0;
+    ip++;
+    DISPATCH();
+    
+check_mul:
+    CHECK_CELL(ip->offset);
+    CHECK_CELL(ip->src);
+do_mul:
+    p[ip->offset] = (p[ip->offset] + (uint32_t)ip->arg * p[ip->src]) & mask;
+    ip++;
+    DISPATCH();
+    
+do_print:
+    machine_write(m, prog->data + ip->src, (size_t)ip->arg);
+    ip++;
+    DISPATCH();
+    
+do_scan:
+    while (*p) {
+        p += ip->arg;
+        if (p < first || p > last) tape_error_stop(c, m, (size_t)(ip - code));
+    }
+    ip++;
+    BLOCK_DISPATCH();
+    
+do_check: {
+    const BoundsCheck *check = &checks[ip - code];
+    long long cell = p - first;
+    if (check->needed && (cell + check->low < 0 ||
+                          cell + check->high >= (long long)c->options.tape_size)) {
+        tape_error_stop(c, m, (size_t)(ip - code));
+    }
+    DISPATCH();
+}
+    
+do_halt:
+#undef CHECK_CELL
+#undef BLOCK_DISPATCH
+#undef DISPATCH
+    machine_flush(m);
+    if (c->options.dump_tape) {
+        dump_cells(first, c->options.tape_size, prog->cell_size);
+    }
+    release_mapping(c);
+}
+
+// Candidate byte lanes of a 16-byte block for a vector scan with the given
+// stride in cells, or 0 if the stride does not tile the block. Forward scans
+// load the block starting at the current cell, backward scans the block
+// ending with it; each candidate cell is represented by its lowest byte.
+static int scan_mask(int stride, int cell_size) {
+    int step = (stride < 0 ? -stride : stride) * cell_size;
+    if (step > SCAN_BLOCK || SCAN_BLOCK % step != 0) {
+        return 0;
+    }
+    
+    int mask = 0;
+    for (int lane = 0; lane < SCAN_BLOCK; lane += step) {
+        mask |= 1 << (stride > 0 ? lane : SCAN_BLOCK - cell_size - lane);
+    }
+    return mask;
+}
+
+// Emit a scan loop: SSE2 compares a 16-byte block against zero per step,
+// falling back to a cell loop for strides that do not tile the block
+static void compile_scan(Compiler *c, const Op *op) {
+    static const Insn compare[] = { 0, I_PCMPEQB, I_PCMPEQW, 0, I_PCMPEQD };
+    Asm *a = c->as;
+    int size = cell_width(c);
+    int number = next_label(c);
+    int loop = asm_new_label(a, "scan", number);
+    int mask = scan_mask(op->arg, size);
+    
+    asm_text(a, "    # [%c x%d]\n", op->arg > 0 ? '>' : '<', abs(op->arg));
+    if (mask == 0) {
+        int done = asm_new_label(a, "scan_done", number);
+        asm_bind(a, loop);
+        asm_op(a, I_CMP, size, imm(0), cell_at(c, 0));
+        asm_jcc(a, CC_E, done);
+        asm_op(a, I_ADD, 8, imm((long long)op->arg * size), reg(R12));
+        asm_jmp(a, loop);
+        asm_bind(a, done);
+        asm_raw(a, "\n");
+        return;
+    }
+    
+    int found = asm_new_label(a, "scan_found", number);
+    asm_op(a, I_PXOR, 16, reg(0), reg(0));
+    asm_bind(a, loop);
+    asm_op(a, I_MOVDQU, 16, mem(R12, op->arg > 0 ? 0 : -(SCAN_BLOCK - size)), reg(1));
+    asm_op(a, compare[size], 16, reg(0), reg(1));
+    asm_op(a, I_PMOVMSKB, 4, reg(1), reg(RAX));
+    if (mask != 0xffff) {
+        asm_op(a, I_AND, 4, imm(mask), reg(RAX));
+    } else {
+        asm_op(a, I_TEST, 4, reg(RAX), reg(RAX));
+    }
+    asm_jcc(a, CC_NE, found);
+    asm_op(a, op->arg > 0 ? I_ADD : I_SUB, 8, imm(SCAN_BLOCK), reg(R12));
+    asm_jmp(a, loop);
+    asm_bind(a, found);
+    if (op->arg > 0) {
+        asm_op(a, I_BSF, 4, reg(RAX), reg(RAX));
+        asm_op(a, I_ADD, 8, reg(RAX), reg(R12));
+    } else {
+        asm_op(a, I_BSR, 4, reg(RAX), reg(RAX));
+        asm_op(a, I_LEA, 8, mem_index(R12, RAX, -(SCAN_BLOCK - size)), reg(R12));
+    }
+    asm_raw(a, "\n");
+}
+
+// Keep the most used cells of an innermost loop in registers while it runs.
+// Only loops without pointer movement qualify, so every cell stays at a fixed
+// offset; cells used once stay in memory.
+#define MAX_LOOP_CELLS 64
+
+static void allocate_cells(Compiler *c, size_t start) {
+    const Op *ops = c->program->ops;
+    size_t end = (size_t)ops[start].arg;
+    int offsets[MAX_LOOP_CELLS];
+    int uses[MAX_LOOP_CELLS];
+    int count = 0;
+    
+    c->cell_reg_count = 0;
+    if (c->options.opt_level < 3) {
+        return;
+    }
+    for (size_t i = start; i <= end; i++) {
+        const Op *op = &ops[i];
+        if ((op->type == OP_JZ && i != start) || op->type == OP_MOVE || op->type == OP_SCAN) {
+            return;
+        }
+        if (op->type == OP_PRINT || i == start) {
+            continue;   // the loop test is counted once, at the OP_JNZ
+        }
+        for (int n = op->type == OP_MUL ? 2 : 1; n > 0; n--) {
+            int offset = n == 2 ? op->src : op->offset;
+            int k = 0;
+            while (k < count && offsets[k] != offset) k++;
+            if (k == count) {
+                if (count == MAX_LOOP_CELLS) return;
+                offsets[count] = offset;
+                uses[count++] = 0;
+            }
+            uses[k]++;
+        }
+    }
+    
+    while (c->cell_reg_count < CELL_REGS) {
+        int best = -1;
+        for (int k = 0; k < count; k++) {
+            if (uses[k] >= 2 && (best < 0 || uses[k] > uses[best])) best = k;
+        }
+        if (best < 0) break;
+        c->cell_regs[c->cell_reg_count++] = offsets[best];
+        uses[best] = 0;
+    }
+}
+
+// Compile single IR operation
+static void compile_instruction(Compiler *c, const Op *op) {
+    Asm *a = c->as;
+    Operand cell = cell_operand(c, op->offset);
+    int size = cell_width(c);
+    long long bytes = (long long)op->arg * size;
+    
+    switch (op->type) {
+        case OP_ADD:
+            if (op->arg == 1) {
+                asm_note(a, "+");
+                asm_op1(a, I_INC, size, cell);
+            } else if (op->arg == -1) {
+                asm_note(a, "-");
+                asm_op1(a, I_DEC, size, cell);
+            } else if (op->arg > 0) {
+                asm_note_count(a, "+", op->arg);
+                asm_op(a, I_ADD, size, imm(op->arg), cell);
+            } else {
+                asm_note_count(a, "-", -(long long)op->arg);
+                asm_op(a, I_SUB, size, imm(-(long long)op->arg), cell);
+            }
+            break;
+    
+        case OP_MOVE:
+            asm_note_count(a, op->arg > 0 ? ">" : "<", abs(op->arg));
+            if (bytes == 1) {
+                asm_op1(a, I_INC, 8, reg(R12));
+            } else if (bytes == -1) {
+                asm_op1(a, I_DEC, 8, reg(R12));
+            } else if (bytes > 0) {
+                asm_op(a, I_ADD, 8, imm(bytes), reg(R12));
+            } else {
+                asm_op(a, I_SUB, 8, imm(-bytes), reg(R12));
+            }
+            break;
+    
+        case OP_OUT:
+            asm_note(a, ".");
+            asm_op(a, I_MOV, 1, cell, reg(RAX));
+            asm_call(a, c->runtime[RT_PUTCHAR]);
+            break;
+    
+        case OP_IN:
+            // bf_getchar stores to memory, and may leave the cell alone
+            if (cell.kind == OPD_REG) {
+                asm_op(a, I_MOV, size, cell, cell_at(c, op->offset));
+            }
+            asm_note(a, ",");
+            asm_op(a, I_LEA, 8, cell_at(c, op->offset), reg(RDI));
+            asm_call(a, c->runtime[RT_GETCHAR]);
+            if (cell.kind == OPD_REG) {
+                asm_op(a, I_MOV, size, cell_at(c, op->offset), cell);
+            }
+            break;
+    
+        case OP_JZ: {
+            size_t index = (size_t)(op - c->program->ops);
+            bool align = c->plans && c->plans[index].align;
+            int label = next_label(c);
+            int start = asm_new_label(a, "loop_start", label);
+            asm_new_label(a, "loop_end", label);        // always start + 1
+            c->jump_labels[index] = start;
+            long long counter = 16 * (long long)c->profile_next;
+            if (c->options.profile) {
+                asm_note(a, "entered");
+                asm_op1(a, I_INC, 8, rip(c->runtime[RT_PROFILE], counter));
+            }
+            
+            // With cells in registers or a bounds check hoisted out of the
+            // body the loop is rotated: they are loaded and checked once
+            // it is entered, and the closing test jumps straight back to
+            // the body
+            allocate_cells(c, index);
+            bool hoist = c->checks && c->checks[index + 1].needed && c->checks[index + 1].hoisted;
+            if (c->cell_reg_count || hoist) {
+                if (c->cell_reg_count) {
+                    asm_new_label(a, "loop_exit", label);   // start + 2
+                }
+                asm_note(a, "[");
+                asm_op(a, I_CMP, size, imm(0), cell);
+                asm_jcc(a, CC_E, start + 1);
+                emit_check(c, index + 1);
+                for (int k = 0; k < c->cell_reg_count; k++) {
+                    asm_op(a, I_MOV, size, cell_at(c, c->cell_regs[k]), reg(cell_registers[k]));
+                }
+                if (align) {
+                    asm_align(a, LOOP_ALIGN);
+                }
+                asm_bind(a, start);
+            } else {
+                if (align) {
+                    asm_align(a, LOOP_ALIGN);
+                }
+                asm_bind(a, start);
+                asm_note(a, "[");
+                asm_op(a, I_CMP, size, imm(0), cell);
+                asm_jcc(a, CC_E, start + 1);
+            }
+            if (c->options.profile) {
+                asm_note(a, "iteration");
+                asm_op1(a, I_INC, 8, rip(c->runtime[RT_PROFILE], counter + 8));
+                c->profile_next++;
+            }
+            if (!hoist) {
+                emit_check(c, index + 1);
+            }
+            asm_raw(a, "\n");
+            break;
+        }
+    
+        case OP_JNZ: {
+            int start = c->jump_labels[op->arg];
+            asm_note(a, "]");
+            asm_op(a, I_CMP, size, imm(0), cell);
+            asm_jcc(a, CC_NE, start);
+            if (c->cell_reg_count) {
+                asm_bind(a, start + 2);
+                for (int k = 0; k < c->cell_reg_count; k++) {
+                    asm_op(a, I_MOV, size, reg(cell_registers[k]), cell_at(c, c->cell_regs[k]));
+                }
+                c->cell_reg_count = 0;
+            }
+            asm_bind(a, start + 1);
+            emit_check(c, (size_t)(op - c->program->ops) + 1);
+            asm_raw(a, "\n");
+            break;
+        }
+    
+        case OP_CLEAR:
+            asm_note(a, "[-]");
+            asm_op(a, I_MOV, size, imm(0), cell);
+            break;
+    
+        case OP_MUL:
+            asm_note(a, "[->+<]");
+            asm_op(a, I_MOV, size, cell_operand(c, op->src), reg(RAX));
+            if (op->arg == -1) {
+                asm_op(a, I_SUB, size, reg(RAX), cell);
+            } else {
+                if (op->arg != 1) {
+                    asm_imul(a, 4, op->arg, reg(RAX), reg(RAX));
+                }
+                asm_op(a, I_ADD, size, reg(RAX), cell);
+            }
+            break;
+    
+        case OP_PRINT:
+            if (op->arg == 1) {
+                asm_note(a, ". (constant)");
+                asm_op(a, I_MOV, 1, imm((unsigned char)c->program->data[op->src]), reg(RAX));
+                asm_call(a, c->runtime[RT_PUTCHAR]);
+            } else {
+                asm_note_count(a, ". (constant)", op->arg);
+                int label = asm_new_label(a, "str", op->src);
+                push_string(c, label, op->src, op->arg);
+                asm_op(a, I_LEA, 8, rip(label, 0), reg(RSI));
+                asm_op(a, I_MOV, 8, imm(op->arg), reg(RDX));
+                asm_call(a, c->runtime[RT_WRITE]);
+            }
+            break;
+    
+        case OP_SCAN:
+            compile_scan(c, op);
+            emit_check(c, (size_t)(op - c->program->ops) + 1);
+            break;
+    }
+}
+
+// Copies made of the body of a loop that walks the tape with a constant
+// stride, so the pointer is advanced once for all of them
+#define STRIDE_COPIES 2
+
+// Exits from between the copies of a walking loop; the one after copy k
+// advances the pointer by k steps
+static const char *const stride_exits[MAX_UNROLL] = {
+    NULL, "loop_exit", "loop_exit2", "loop_exit3"
+};
+
+// How many copies of the body of the loop opened at `start` to emit: as its
+// plan says, or STRIDE_COPIES for an innermost loop that ends in a move
+static int loop_copies(const Compiler *c, size_t start) {
+    const Op *ops = c->program->ops;
+    size_t end = (size_t)ops[start].arg;
+    if (c->checks && c->checks[start + 1].needed && !c->checks[start + 1].hoisted) {
+        return 1;   // the check at the top of the body runs every iteration
+    }
+    if (c->plans && c->plans[start].unroll > 1) {
+        return c->plans[start].unroll;
+    }
+    if (ops[end - 1].type == OP_MOVE && c->options.opt_level >= 3 && can_unroll(c->program, start)) {
+        return STRIDE_COPIES;
+    }
+    return 1;
+}
+
+// Emit the body of the loop opened at `start` `copies` times, testing the
+// loop cell between copies, after compile_instruction has emitted the
+// OP_JZ. A body that ends in a move of `step` cells is emitted without it:
+// copy k addresses its cells k steps further on, and one move of
+// copies * step follows the last copy. Returns the index of the last
+// operation emitted.
+static size_t compile_unrolled(Compiler *c, size_t start, int copies) {
+    Asm *a = c->as;
+    const Op *ops = c->program->ops;
+    size_t end = (size_t)ops[start].arg;
+    int step = ops[end - 1].type == OP_MOVE ? ops[end - 1].arg : 0;
+    size_t body_end = step ? end - 1 : end;
+    long long counter = 16 * ((long long)c->profile_next - 1) + 8;
+    int exits[MAX_UNROLL];
+    
+    for (int k = 1; step && k < copies; k++) {
+        exits[k] = asm_new_label(a, stride_exits[k], a->labels[c->jump_labels[start]].number);
+    }
+    for (int copy = 0; copy < copies; copy++) {
+        if (copy > 0) {
+            asm_note(a, "] [ (unrolled)");
+            asm_op(a, I_CMP, cell_width(c), imm(0), cell_operand(c, ops[end].offset + copy * step));
+            asm_jcc(a, CC_E, step ? exits[copy] : c->jump_labels[start] + (c->cell_reg_count ? 2 : 1));
+            if (c->options.profile) {
+                asm_note(a, "iteration");
+                asm_op1(a, I_INC, 8, rip(c->runtime[RT_PROFILE], counter));
+            }
+        }
+        for (size_t i = start + 1; i < body_end; i++) {
+            Op op = ops[i];
+            op.offset += copy * step;
+            if (op.type == OP_MUL) {
+                op.src += copy * step;
+            }
+            compile_instruction(c, &op);
+        }
+    }
+    if (!step) {
+        return end - 1;
+    }
+    
+    // The closing test, then the exits, which fall through to the loop end
+    Op move = ops[end - 1];
+    move.arg = copies * step;
+    compile_instruction(c, &move);
+    asm_note(a, "]");
+    asm_op(a, I_CMP, cell_width(c), imm(0), cell_operand(c, ops[end].offset));
+    asm_jcc(a, CC_NE, c->jump_labels[start]);
+    asm_jmp(a, c->jump_labels[start] + 1);
+    move.arg = step;
+    for (int k = copies - 1; k > 0; k--) {
+        asm_bind(a, exits[k]);
+        compile_instruction(c, &move);
+    }
+    asm_bind(a, c->jump_labels[start] + 1);
+    emit_check(c, end + 1);
+    asm_raw(a, "\n");
+    return end;
+}
+
+// AArch64 backend: GNU as text from the same IR. The data pointer lives in
+// x19, the output cursor in x20 and the end of out_buf in x23, the input
+// cursor and end in x21/x22. Neither system calls nor the runtime routines
+// change x19-x23; w0-w3, x8 and x9 are scratch.
+
+// cbz/cbnz reach 1 MiB either way, and no IR operation takes more than 16
+// instructions, so loops with fewer operations than this branch directly
+#define A64_NEAR_OPS ((1 << 20) / (16 * 4))
+
+// Print one instruction line, with the pending note
+static void a64(Asm *a, const char *format, ...) {
+    va_list args;
+    a->line_start = a->out.size;
+    buffer_str(&a->out, "    ");
+    va_start(args, format);
+    buffer_vprintf(&a->out, format, args);
+    va_end(args);
+    text_end(a);
+}
+
+// Instruction ending in a label, e.g. a64_label(a, "cbz w0, ", loop_end)
+static void a64_label(Asm *a, const char *prefix, int label) {
+    a->line_start = a->out.size;
+    buffer_str(&a->out, "    ");
+    buffer_str(&a->out, prefix);
+    text_label(a, label);
+    text_end(a);
+}
+
+// Load the address of a label into x<reg>
+static void a64_address(Asm *a, int reg, int label) {
+    char buf[64];
+    const char *name = label_name(a, label, buf, sizeof(buf));
+    a64(a, "adrp x%d, %s", reg, name);
+    a64(a, "add x%d, x%d, :lo12:%s", reg, reg, name);
+}
+
+// Load a constant into <kind><reg>, kind 'w' or 'x', 16 bits at a time
+static void a64_mov_imm(Asm *a, char kind, int reg, long long value) {
+    uint64_t bits = kind == 'w' ? (uint32_t)value : (uint64_t)value;
+    int chunks = kind == 'w' ? 2 : 4;
+    
+    if (value >= -65536 && value < 65536) {
+        a64(a, "mov %c%d, #%lld", kind, reg, value);
+        return;
+    }
+    a64(a, "movz %c%d, #%llu", kind, reg, (unsigned long long)(bits & 0xffff));
+    for (int i = 1; i < chunks; i++) {
+        unsigned long long chunk = (bits >> (16 * i)) & 0xffff;
+        if (chunk != 0) {
+            a64(a, "movk %c%d, #%llu, lsl #%d", kind, reg, chunk, 16 * i);
+        }
+    }
+}
+
+// <kind><dst> = <kind><src> + value; large values go through x9/w9
+static void a64_add_imm(Asm *a, char kind, int dst, int src, long long value) {
+    const char *insn = value < 0 ? "sub" : "add";
+    long long magnitude = value < 0 ? -value : value;
+    
+    if (magnitude == 0) {
+        a64(a, "mov %c%d, %c%d", kind, dst, kind, src);
+    } else if (magnitude < 4096) {
+        a64(a, "%s %c%d, %c%d, #%lld", insn, kind, dst, kind, src, magnitude);
+    } else if (magnitude % 4096 == 0 && magnitude / 4096 < 4096) {
+        a64(a, "%s %c%d, %c%d, #%lld, lsl #12", insn, kind, dst, kind, src, magnitude / 4096);
+    } else {
+        const char *note = a->note;
+        a->note = NULL;
+        a64_mov_imm(a, kind, 9, value);
+        a->note = note;
+        a64(a, "add %c%d, %c%d, %c9", kind, dst, kind, src, kind);
+    }
+}
+
+// Load or store cell[offset] through register `reg`, using the scaled, the
+// unscaled or a register offset as the distance needs
+static void a64_cell(Compiler *c, bool store, const char *reg, int offset) {
+    static const char *suffix[] = { NULL, "b", "h", NULL, "" };
+    Asm *a = c->as;
+    const char *insn = store ? "st" : "ld";
+    int size = cell_width(c);
+    long long disp = (long long)offset * size;
+    
+    if (disp == 0) {
+        a64(a, "%sr%s %s, [x19]", insn, suffix[size], reg);
+    } else if (disp > 0 && disp / size < 4096) {
+        a64(a, "%sr%s %s, [x19, #%lld]", insn, suffix[size], reg, disp);
+    } else if (disp >= -256 && disp < 256) {
+        a64(a, "%sur%s %s, [x19, #%lld]", insn, suffix[size], reg, disp);
+    } else {
+        const char *note = a->note;
+        a->note = NULL;
+        a64_mov_imm(a, 'x', 9, disp);
+        a->note = note;
+        a64(a, "%sr%s %s, [x19, x9]", insn, suffix[size], reg);
+    }
+}
+
+// Emit a system call; the arguments are already in place
+static void a64_syscall(Compiler *c, int number, const char *name) {
+    asm_note(c->as, name);
+    a64(c->as, "mov x8, #%d", number);
+    a64(c->as, "svc #0");
+}
+
+// Emit the data, the entry point and the register setup
+static void a64_header(Compiler *c) {
+    Asm *a = c->as;
+    int *rt = c->runtime;
+    
+    asm_section(a, SEC_BSS);
+    asm_align(a, 64);
+    asm_bind(a, rt[RT_OUT_BUF]);
+    asm_zero(a, OUTPUT_BUFFER_SIZE);
+    asm_bind(a, rt[RT_IN_BUF]);
+    asm_zero(a, INPUT_BUFFER_SIZE);
+    
+    // The tape is padded so vector scans can read a full block near its ends
+    if (c->options.tape_mode == TAPE_STATIC) {
+        asm_zero(a, SCAN_BLOCK);
+        asm_bind(a, rt[RT_MEMORY]);
+        asm_zero(a, c->options.tape_size * c->options.cell_size);
+        asm_zero(a, SCAN_BLOCK);
+    } else {
+        asm_section(a, SEC_DATA);
+        asm_align(a, 8);
+        asm_bind(a, rt[RT_SIGACTION]);
+        asm_quad_label(a, rt[RT_SEGV_HANDLER]);
+        asm_note(a, "SA_SIGINFO | SA_RESTORER");
+        asm_quad(a, 0x04000004);
+        asm_quad_label(a, rt[RT_SIGRETURN]);
+        asm_note(a, "blocked signals");
+        asm_quad(a, 0);
+        asm_section(a, SEC_RODATA);
+        asm_bind(a, rt[RT_TAPE_ERROR]);
+        asm_ascii(a, tape_error, sizeof(tape_error) - 1);
+    }
+    
+    asm_section(a, SEC_TEXT);
+    asm_raw(a, "    .globl _start\n\n");
+    asm_bind(a, rt[RT_START]);
+    
+    if (c->options.tape_mode == TAPE_MMAP) {
+        size_t total = mapped_tape_size(c);
+        
+        asm_raw(a, "    // Map the tape; untouched pages cost nothing\n");
+        a64(a, "mov x0, #0");
+        a64_mov_imm(a, 'x', 1, (long long)total);
+        asm_note(a, "PROT_READ | PROT_WRITE");
+        a64(a, "mov x2, #3");
+        asm_note(a, "MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE");
+        a64(a, "mov x3, #0x4022");
+        a64(a, "mov x4, #-1");
+        a64(a, "mov x5, #0");
+        a64_syscall(c, 222, "sys_mmap");
+        a64(a, "cmn x0, #4095");
+        a64_label(a, "b.hs ", rt[RT_WRITE_ERROR]);
+        a64(a, "mov x24, x0");
+        a64_add_imm(a, 'x', 19, 24, PAGE_SIZE + SCAN_BLOCK);
+        
+        asm_raw(a, "    // Guard pages below and above the tape\n");
+        a64(a, "mov x0, x24");
+        a64(a, "mov x1, #%d", PAGE_SIZE);
+        asm_note(a, "PROT_NONE");
+        a64(a, "mov x2, #0");
+        a64_syscall(c, 226, "sys_mprotect");
+        a64_add_imm(a, 'x', 0, 24, (long long)(total - PAGE_SIZE));
+        a64(a, "mov x1, #%d", PAGE_SIZE);
+        a64(a, "mov x2, #0");
+        a64_syscall(c, 226, "sys_mprotect");
+        
+        asm_raw(a, "    // Report guard page hits instead of dying silently\n");
+        asm_note(a, "SIGSEGV");
+        a64(a, "mov x0, #11");
+        a64_address(a, 1, rt[RT_SIGACTION]);
+        a64(a, "mov x2, #0");
+        asm_note(a, "sizeof(sigset_t)");
+        a64(a, "mov x3, #8");
+        a64_syscall(c, 134, "sys_rt_sigaction");
+    } else {
+        a64_address(a, 19, rt[RT_MEMORY]);
+    }
+    
+    asm_raw(a, "    // Data pointer in x19, output cursor and end in x20/x23,\n");
+    asm_raw(a, "    // input cursor and end in x21/x22 (buffer starts empty)\n");
+    a64_address(a, 20, rt[RT_OUT_BUF]);
+    a64_add_imm(a, 'x', 23, 20, OUTPUT_BUFFER_SIZE);
+    a64_address(a, 21, rt[RT_IN_BUF]);
+    a64(a, "mov x22, x21");
+    asm_raw(a, "\n");
+}
+
+// Emit the exit and the runtime support routines, which mirror the x86-64
+// ones in emit_footer
+static void a64_footer(Compiler *c) {
+    static const char *suffix[] = { NULL, "b", "h", NULL, "" };
+    Asm *a = c->as;
+    int *rt = c->runtime;
+    int flush_loop = asm_new_label(a, "bf_flush_loop", -1);
+    int flush_done = asm_new_label(a, "bf_flush_done", -1);
+    int getchar_ready = asm_new_label(a, "bf_getchar_ready", -1);
+    int fill = asm_new_label(a, "bf_fill", -1);
+    int eof = asm_new_label(a, "bf_eof", -1);
+    int write_next = asm_new_label(a, "bf_write_next", -1);
+    const char *store = suffix[cell_width(c)];
+    
+    asm_raw(a, "\n    // Exit program\n");
+    a64_label(a, "bl ", rt[RT_FLUSH]);
+    asm_note(a, "exit code 0");
+    a64(a, "mov x0, #0");
+    a64_syscall(c, 93, "sys_exit");
+    asm_raw(a, "\n");
+    
+    // bf_putchar: append w0 to the output buffer, flushing when it fills
+    asm_bind(a, rt[RT_PUTCHAR]);
+    a64(a, "strb w0, [x20], #1");
+    a64(a, "cmp x20, x23");
+    a64_label(a, "b.hs ", rt[RT_FLUSH]);
+    a64(a, "ret");
+    asm_raw(a, "\n");
+    
+    // bf_flush: write out_buf up to x20, retrying short writes
+    asm_bind(a, rt[RT_FLUSH]);
+    a64_address(a, 1, rt[RT_OUT_BUF]);
+    asm_bind(a, flush_loop);
+    asm_note(a, "bytes pending");
+    a64(a, "subs x2, x20, x1");
+    a64_label(a, "b.eq ", flush_done);
+    asm_note(a, "stdout");
+    a64(a, "mov x0, #1");
+    a64_syscall(c, 64, "sys_write");
+    a64(a, "cmp x0, #0");
+    a64_label(a, "b.le ", rt[RT_WRITE_ERROR]);
+    a64(a, "add x1, x1, x0");
+    a64_label(a, "b ", flush_loop);
+    asm_bind(a, flush_done);
+    a64_address(a, 20, rt[RT_OUT_BUF]);
+    a64(a, "ret");
+    asm_raw(a, "\n");
+    
+    // bf_getchar: store the next input byte at [x0], refilling in_buf
+    // with one large read when it runs dry
+    asm_bind(a, rt[RT_GETCHAR]);
+    a64(a, "cmp x21, x22");
+    a64_label(a, "b.hs ", fill);
+    asm_bind(a, getchar_ready);
+    a64(a, "ldrb w1, [x21], #1");
+    a64(a, "str%s w1, [x0]", store);
+    a64(a, "ret");
+    asm_raw(a, "\n");
+    
+    asm_bind(a, fill);
+    a64(a, "stp x0, x30, [sp, #-16]!");
+    asm_note(a, "show pending output first");
+    a64_label(a, "bl ", rt[RT_FLUSH]);
+    asm_note(a, "stdin");
+    a64(a, "mov x0, #0");
+    a64_address(a, 1, rt[RT_IN_BUF]);
+    a64(a, "mov x2, #%d", INPUT_BUFFER_SIZE);
+    a64_syscall(c, 63, "sys_read");
+    a64(a, "mov x3, x0");
+    a64(a, "ldp x0, x30, [sp], #16");
+    a64(a, "cmp x3, #0");
+    asm_note(a, "end of input or read error");
+    a64_label(a, "b.le ", eof);
+    a64_address(a, 21, rt[RT_IN_BUF]);
+    a64(a, "add x22, x21, x3");
+    a64_label(a, "b ", getchar_ready);
+    
+    asm_bind(a, eof);
+    switch (c->options.eof_mode) {
+        case EOF_UNCHANGED:
+            break;
+        case EOF_ZERO:
+            a64(a, "str%s wzr, [x0]", store);
+            break;
+        case EOF_MINUS_ONE:
+            a64(a, "mov w1, #-1");
+            a64(a, "str%s w1, [x0]", store);
+            break;
+    }
+    a64(a, "ret");
+    asm_raw(a, "\n");
+    
+    // bf_write: copy x2 (at least one) bytes from x1 into the output buffer
+    asm_bind(a, rt[RT_WRITE]);
+    a64(a, "ldrb w3, [x1], #1");
+    a64(a, "strb w3, [x20], #1");
+    a64(a, "cmp x20, x23");
+    a64_label(a, "b.lo ", write_next);
+    a64(a, "stp x1, x2, [sp, #-32]!");
+    a64(a, "str x30, [sp, #16]");
+    a64_label(a, "bl ", rt[RT_FLUSH]);
+    a64(a, "ldr x30, [sp, #16]");
+    a64(a, "ldp x1, x2, [sp], #32");
+    asm_bind(a, write_next);
+    a64(a, "subs x2, x2, #1");
+    a64_label(a, "b.ne ", rt[RT_WRITE]);
+    a64(a, "ret");
+    asm_raw(a, "\n");
+    
+    if (c->options.tape_mode == TAPE_MMAP) {
+        // Flush what the program printed so far; the handler is entered
+        // with x20 as it was when the fault happened
+        asm_bind(a, rt[RT_SEGV_HANDLER]);
+        a64_label(a, "bl ", rt[RT_FLUSH]);
+        asm_note(a, "stderr");
+        a64(a, "mov x0, #2");
+        a64_address(a, 1, rt[RT_TAPE_ERROR]);
+        a64(a, "mov x2, #%d", (int)sizeof(tape_error) - 1);
+        a64_syscall(c, 64, "sys_write");
+        a64_label(a, "b ", rt[RT_WRITE_ERROR]);
+        asm_raw(a, "\n");
+        
+        asm_bind(a, rt[RT_SIGRETURN]);
+        a64_syscall(c, 139, "sys_rt_sigreturn");
+        asm_raw(a, "\n");
+    }
+    
+    asm_bind(a, rt[RT_WRITE_ERROR]);
+    asm_note(a, "exit code 1");
+    a64(a, "mov x0, #1");
+    a64_syscall(c, 93, "sys_exit");
+}
+
+// Emit a scan loop: NEON compares a 16-byte block against zero per step.
+// There is no movemask, so shrn narrows the compare result to one nibble
+// per byte in x0, masked to the candidate cells like scan_mask's bits.
+static void a64_scan(Compiler *c, const Op *op) {
+    static const char *lanes[] = { NULL, "16b", "8h", NULL, "4s" };
+    Asm *a = c->as;
+    int size = cell_width(c);
+    int number = next_label(c);
+    int loop = asm_new_label(a, "scan", number);
+    int mask = scan_mask(op->arg, size);
+    
+    asm_text(a, "    // [%c x%d]\n", op->arg > 0 ? '>' : '<', abs(op->arg));
+    if (mask == 0) {
+        int done = asm_new_label(a, "scan_done", number);
+        asm_bind(a, loop);
+        a64_cell(c, false, "w0", 0);
+        a64_label(a, "cbz w0, ", done);
+        a64_add_imm(a, 'x', 19, 19, (long long)op->arg * size);
+        a64_label(a, "b ", loop);
+        asm_bind(a, done);
+        asm_raw(a, "\n");
+        return;
+    }
+    
+    int found = asm_new_label(a, "scan_found", number);
+    uint64_t nibbles = 0;
+    for (int i = 0; i < SCAN_BLOCK; i++) {
+        if (mask & (1 << i)) nibbles |= UINT64_C(0xf) << (4 * i);
+    }
+    if (mask != 0xffff) {
+        a64_mov_imm(a, 'x', 1, (long long)nibbles);
+    }
+    asm_bind(a, loop);
+    if (op->arg > 0) {
+        a64(a, "ldr q0, [x19]");
+    } else {
+        a64(a, "ldur q0, [x19, #-%d]", SCAN_BLOCK - size);
+    }
+    a64(a, "cmeq v0.%s, v0.%s, #0", lanes[size], lanes[size]);
+    a64(a, "shrn v0.8b, v0.8h, #4");
+    a64(a, "fmov x0, d0");
+    if (mask != 0xffff) {
+        a64(a, "and x0, x0, x1");
+    }
+    a64_label(a, "cbnz x0, ", found);
+    a64(a, "%s x19, x19, #%d", op->arg > 0 ? "add" : "sub", SCAN_BLOCK);
+    a64_label(a, "b ", loop);
+    asm_bind(a, found);
+    if (op->arg > 0) {
+        a64(a, "rbit x0, x0");
+        a64(a, "clz x0, x0");
+        a64(a, "add x19, x19, x0, lsr #2");
+    } else {
+        a64(a, "clz x0, x0");
+        a64(a, "sub x19, x19, x0, lsr #2");
+        if (size > 1) {
+            a64(a, "add x19, x19, #%d", size - 1);
+        }
+    }
+    asm_raw(a, "\n");
+}
+
+// Compile single IR operation for AArch64
+static void a64_instruction(Compiler *c, const Op *op) {
+    Asm *a = c->as;
+    int size = cell_width(c);
+    
+    switch (op->type) {
+        case OP_ADD:
+            a64_cell(c, false, "w0", op->offset);
+            if (op->arg == 1 || op->arg == -1) {
+                asm_note(a, op->arg > 0 ? "+" : "-");
+            } else {
+                asm_note_count(a, op->arg > 0 ? "+" : "-", op->arg > 0 ? op->arg : -(long long)op->arg);
+            }
+            a64_add_imm(a, 'w', 0, 0, op->arg);
+            a64_cell(c, true, "w0", op->offset);
+            break;
+        
+        case OP_MOVE:
+            asm_note_count(a, op->arg > 0 ? ">" : "<", abs(op->arg));
+            a64_add_imm(a, 'x', 19, 19, (long long)op->arg * size);
+            break;
+        
+        case OP_OUT:
+            asm_note(a, ".");
+            a64_cell(c, false, "w0", op->offset);
+            a64_label(a, "bl ", c->runtime[RT_PUTCHAR]);
+            break;
+        
+        case OP_IN:
+            asm_note(a, ",");
+            a64_add_imm(a, 'x', 0, 19, (long long)op->offset * size);
+            a64_label(a, "bl ", c->runtime[RT_GETCHAR]);
+            break;
+        
+        case OP_JZ: {
+            size_t index = (size_t)(op - c->program->ops);
+            int label = next_label(c);
+            int start = asm_new_label(a, "loop_start", label);
+            asm_new_label(a, "loop_end", label);        // always start + 1
+            c->jump_labels[index] = start;
+            if (c->plans && c->plans[index].align) {
+                asm_align(a, LOOP_ALIGN);
+            }
+            asm_bind(a, start);
+            asm_note(a, "[");
+            a64_cell(c, false, "w0", op->offset);
+            if ((size_t)op->arg - index < A64_NEAR_OPS) {
+                a64_label(a, "cbz w0, ", start + 1);
+            } else {
+                a64(a, "cbnz w0, .+8");
+                a64_label(a, "b ", start + 1);
+            }
+            asm_raw(a, "\n");
+            break;
+        }
+        
+        case OP_JNZ: {
+            int start = c->jump_labels[op->arg];
+            asm_note(a, "]");
+            a64_cell(c, false, "w0", op->offset);
+            if ((size_t)(op - c->program->ops) - (size_t)op->arg < A64_NEAR_OPS) {
+                a64_label(a, "cbnz w0, ", start);
+            } else {
+                a64(a, "cbz w0, .+8");
+                a64_label(a, "b ", start);
+            }
+            asm_bind(a, start + 1);
+            asm_raw(a, "\n");
+            break;
+        }
+        
+        case OP_CLEAR:
+            asm_note(a, "[-]");
+            a64_cell(c, true, "wzr", op->offset);
+            break;
+        
+        case OP_MUL:
+            asm_note(a, "[->+<]");
+            a64_cell(c, false, "w1", op->src);
+            a64_cell(c, false, "w2", op->offset);
+            if (op->arg == 1) {
+                a64(a, "add w2, w2, w1");
+            } else if (op->arg == -1) {
+                a64(a, "sub w2, w2, w1");
+            } else {
+                a64_mov_imm(a, 'w', 3, op->arg);
+                a64(a, "madd w2, w1, w3, w2");
+            }
+            a64_cell(c, true, "w2", op->offset);
+            break;
+        
+        case OP_PRINT:
+            if (op->arg == 1) {
+                asm_note(a, ". (constant)");
+                a64(a, "mov w0, #%d", (unsigned char)c->program->data[op->src]);
+                a64_label(a, "bl ", c->runtime[RT_PUTCHAR]);
+            } else {
+                asm_note_count(a, ". (constant)", op->arg);
+                int label = asm_new_label(a, "str", op->src);
+                push_string(c, label, op->src, op->arg);
+                a64_address(a, 1, label);
+                a64_mov_imm(a, 'x', 2, op->arg);
+                a64_label(a, "bl ", c->runtime[RT_WRITE]);
+            }
+            break;
+        
+        case OP_SCAN:
+            a64_scan(c, op);
+            break;
+    }
+}
+
+// Emit the constant strings used by OP_PRINT
+static void emit_data(Compiler *c, Program *prog) {
+    asm_section(c->as, SEC_RODATA);
+    for (size_t i = 0; i < c->string_count; i++) {
+        const PendingString *str = &c->strings[i];
+        asm_bind(c->as, str->label);
+        asm_ascii(c->as, prog->data + str->start, (size_t)str->length);
+    }
+}
+
+// Main compilation function
+static void compile(Compiler *c, Source *src) {
+    double start = now_ms();
+    c->source = src;
+    Program *prog = parse(c, src);
+    record_phase(c, "parse", start, 0, prog->count);
+    optimize(c, prog);
+    if (c->stats) {
+        c->stats->scan_loops = prog->scan_loops;
+        c->stats->clear_loops = prog->clear_loops;
+        c->stats->mul_loops = prog->mul_loops;
+        c->stats->dead_loops = prog->dead_loops;
+        c->stats->loops = count_loops(prog);
+    }
+    
+    start = now_ms();
+    bool plan = c->options.use_profile && c->options.format != FORMAT_INTERPRET;
+    if (c->options.profile) {
+        build_profile(c, prog, src);
+    }
+    if (plan) {
+        plan_loops(c, prog, src);
+    }
+    if (c->options.profile || plan) {
+        record_phase(c, "profile", start, prog->count, prog->count);
+    }
+    c->program = prog;
+    if (c->options.safe) {
+        start = now_ms();
+        plan_checks(c, prog);
+        record_phase(c, "bounds", start, prog->count, prog->count);
+    }
+    
+    if (c->options.format == FORMAT_INTERPRET) {
+        start = now_ms();
+        interpret(c, prog);
+        if (c->options.profile) {
+            write_profile(c, src->name);
+        }
+        record_phase(c, "interpret", start, prog->count, prog->count);
+        return;
+    }
+    
+    start = now_ms();
+    c->as = create_asm(&c->arena, c->options.format != FORMAT_ASM, c->sink);
+    c->jump_labels = arena_alloc(&c->arena, sizeof(int) * prog->count);
+    for (int i = 0; i < RT_COUNT; i++) {
+        c->runtime[i] = asm_new_label(c->as, runtime_names[i], -1);
+    }
+    
+    if (c->options.target == TARGET_AARCH64) {
+        c->as->comment = "//";
+        a64_header(c);
+        for (size_t i = 0; i < prog->count; i++) {
+            a64_instruction(c, &prog->ops[i]);
+        }
+        a64_footer(c);
+    } else {
+        emit_header(c);
+        emit_check(c, 0);
+        for (size_t i = 0; i < prog->count; i++) {
+            compile_instruction(c, &prog->ops[i]);
+            int copies = prog->ops[i].type == OP_JZ ? loop_copies(c, i) : 1;
+            if (copies > 1) {
+                i = compile_unrolled(c, i, copies);
+            }
+        }
+        emit_footer(c);
+        if (c->checks) {
+            emit_bounds_errors(c);
+        }
+        if (c->options.profile) {
+            emit_profile(c, src->name);
+        }
+    }
+    emit_data(c, prog);
+    
+    if (c->options.format == FORMAT_ELF) {
+        asm_write_elf(c->as, c->sink, c->runtime[RT_START]);
+    } else if (c->options.format == FORMAT_ASM) {
+        asm_flush(c->as);
+    }
+    record_phase(c, "emit", start, prog->count, prog->count);
+    
+    if (c->options.format == FORMAT_JIT) {
+        start = now_ms();
+        asm_run(c, c->runtime[RT_START]);
+        record_phase(c, "run", start, prog->count, prog->count);
+    }
+}
+
+// Cleanup
+static void free_compiler(Compiler *c) {
+    arena_release(&c->arena);
+    free(c);
+}
+
+// Compilation cache. Entries are keyed by a hash of the command stream with
+// comments stripped, the options that change the output, and the build of
+// the compiler. Each entry stores the stream it was made from and a hit
+// requires an exact match, so a hash collision is only a miss.
+#define CACHE_MAGIC UINT64_C(0x0165686361636662)    // "bfcache\1"
+
+static const char cache_build[] = __DATE__ " " __TIME__;
+
+typedef struct {
+    uint64_t magic;
+    uint64_t code_length;       // canonical source bytes that follow
+    uint64_t output_length;     // output bytes after those
+} CacheHeader;
+
+// The source with everything but the eight commands removed
+static Buffer canonical_source(Arena *arena, const char *code, size_t length) {
+    Buffer b = { arena, NULL, 0, 0 };
+    char *dst = buffer_reserve(&b, length + 1);
+    for (size_t i = 0; i < length; i++) {
+        dst[b.size] = code[i];
+        b.size += is_command[(unsigned char)code[i]];
+    }
+    return b;
+}
+
+// 64-bit FNV-1a
+static uint64_t hash_bytes(uint64_t hash, const void *data, size_t size) {
+    const unsigned char *p = data;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= p[i];
+        hash *= UINT64_C(0x100000001b3);
+    }
+    return hash;
+}
+
+static uint64_t cache_key(const Options *options, const Buffer *canonical) {
+    uint64_t fields[] = {
+        options->format, options->eof_mode, options->tape_mode,
+        options->tape_size, (uint64_t)options->cell_size, options->target,
+        options->safe, (uint64_t)options->opt_level, options->dump_tape
+    };
+    uint64_t hash = UINT64_C(0xcbf29ce484222325);
+    hash = hash_bytes(hash, cache_build, sizeof(cache_build));
+    hash = hash_bytes(hash, fields, sizeof(fields));
+    return hash_bytes(hash, canonical->bytes, canonical->size);
+}
+
+static bool read_full(int fd, void *data, size_t size) {
+    while (size > 0) {
+        ssize_t n = read(fd, data, size);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        data = (char *)data + n;
+        size -= (size_t)n;
+    }
+    return true;
+}
+
+static bool write_full(int fd, const void *data, size_t size) {
+    while (size > 0) {
+        ssize_t n = write(fd, data, size);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        data = (const char *)data + n;
+        size -= (size_t)n;
+    }
+    return true;
+}
+
+// Send a cached output to the sink; false if there is no valid entry for
+// exactly this source
+static bool cache_fetch(Arena *arena, const char *path, const Buffer *canonical, bfc_sink *sink) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    
+    struct stat st;
+    CacheHeader h;
+    char *entry = NULL;
+    bool hit = fstat(fd, &st) == 0 && read_full(fd, &h, sizeof(h)) &&
+               h.magic == CACHE_MAGIC && h.code_length == canonical->size &&
+               h.output_length <= (uint64_t)st.st_size &&
+               sizeof(h) + h.code_length + h.output_length == (uint64_t)st.st_size;
+    if (hit) {
+        entry = arena_alloc(arena, (size_t)(h.code_length + h.output_length));
+        hit = read_full(fd, entry, (size_t)(h.code_length + h.output_length));
+    }
+    close(fd);
+    
+    hit = hit && memcmp(entry, canonical->bytes, canonical->size) == 0;
+    if (hit) {
+        sink_write(sink, entry + h.code_length, (size_t)h.output_length);
+    }
+    return hit;
+}
+
+// Add an entry. The cache is best-effort: any failure just leaves the entry
+// out. Entries are written under a temporary name and renamed into place,
+// so concurrent compilers never see a partial one.
+static void cache_store(const char *dir, const char *path, const Buffer *canonical, const Buffer *output) {
+    char temp[PATH_MAX + 8];    // path and ".XXXXXX"
+    snprintf(temp, sizeof(temp), "%s.XXXXXX", path);
+    int fd = mkstemp(temp);
+    if (fd < 0 && errno == ENOENT && mkdir(dir, 0755) == 0) {
+        snprintf(temp, sizeof(temp), "%s.XXXXXX", path);
+        fd = mkstemp(temp);
+    }
+    if (fd < 0) {
+        return;
+    }
+    fchmod(fd, 0644);
+    
+    CacheHeader h = { CACHE_MAGIC, canonical->size, output->size };
+    bool ok = write_full(fd, &h, sizeof(h)) &&
+              write_full(fd, canonical->bytes, canonical->size) &&
+              write_full(fd, output->bytes, output->size);
+    ok = close(fd) == 0 && ok;
+    if (!ok || rename(temp, path) != 0) {
+        unlink(temp);
+    }
+}
+
+// Sink that keeps a copy of everything it forwards, for cache_store
+typedef struct {
+    bfc_sink *sink;
+    Buffer copy;
+} CacheCapture;
+
+static int capture_write(void *context, const void *data, size_t size) {
+    CacheCapture *capture = context;
+    buffer_append(&capture->copy, data, size);
+    return capture->sink->write(capture->sink->context, data, size);
+}
+
+// Sink that measures the output for bfc_stats
+typedef struct {
+    bfc_sink *sink;
+    size_t bytes;
+} CountingSink;
+
+static int count_write(void *context, const void *data, size_t size) {
+    CountingSink *counter = context;
+    counter->bytes += size;
+    return counter->sink->write(counter->sink->context, data, size);
+}
+
+// Library interface, see bfc.h
+
+// Compiler reused by every bfc_compile call on this thread
+static _Thread_local Compiler *thread_compiler;
+
+// Translate public options, rejecting values the compiler cannot honour
+static void convert_options(const bfc_options *in, Options *out) {
+    switch (in->format) {
+        case BFC_FORMAT_ASM: out->format = FORMAT_ASM; break;
+        case BFC_FORMAT_ELF: out->format = FORMAT_ELF; break;
+        case BFC_FORMAT_RUN: out->format = FORMAT_JIT; break;
+        case BFC_FORMAT_INTERPRET: out->format = FORMAT_INTERPRET; break;
+        default: fail(BFC_ERR_OPTIONS, "Unknown output format: %d", (int)in->format);
+    }
+    switch (in->eof_mode) {
+        case BFC_EOF_UNCHANGED: out->eof_mode = EOF_UNCHANGED; break;
+        case BFC_EOF_ZERO: out->eof_mode = EOF_ZERO; break;
+        case BFC_EOF_MINUS_ONE: out->eof_mode = EOF_MINUS_ONE; break;
+        default: fail(BFC_ERR_OPTIONS, "Unknown EOF mode: %d", (int)in->eof_mode);
+    }
+    switch (in->tape_mode) {
+        case BFC_TAPE_STATIC: out->tape_mode = TAPE_STATIC; break;
+        case BFC_TAPE_MMAP: out->tape_mode = TAPE_MMAP; break;
+        default: fail(BFC_ERR_OPTIONS, "Unknown tape mode: %d", (int)in->tape_mode);
+    }
+    
+    out->tape_size = in->tape_size ? in->tape_size : MEMORY_SIZE;
+    if (out->tape_size > MAX_TAPE_SIZE) {
+        fail(BFC_ERR_OPTIONS, "Invalid tape size: %zu", in->tape_size);
+    }
+    int bits = in->cell_bits ? in->cell_bits : 8;
+    if (bits != 8 && bits != 16 && bits != 32) {
+        fail(BFC_ERR_OPTIONS, "Invalid cell size: %d", in->cell_bits);
+    }
+    out->cell_size = bits / 8;
+    out->profile = in->profile_path;
+    out->use_profile = in->use_profile;
+    out->safe = in->safe != 0;
+    out->dump_tape = in->dump_tape != 0;
+    switch (in->opt_level) {
+        case BFC_OPT_DEFAULT: out->opt_level = 3; break;
+        case BFC_OPT_0: out->opt_level = 0; break;
+        case BFC_OPT_1: out->opt_level = 1; break;
+        case BFC_OPT_2: out->opt_level = 2; break;
+        case BFC_OPT_3: out->opt_level = 3; break;
+        default: fail(BFC_ERR_OPTIONS, "Unknown optimization level: %d", (int)in->opt_level);
+    }
+    
+    switch (in->target) {
+        case BFC_TARGET_X86_64: out->target = TARGET_X86_64; break;
+        case BFC_TARGET_AARCH64: out->target = TARGET_AARCH64; break;
+        default: fail(BFC_ERR_OPTIONS, "Unknown target: %d", (int)in->target);
+    }
+    if (out->target == TARGET_AARCH64) {
+        if (out->format == FORMAT_ELF || out->format == FORMAT_JIT) {
+            fail(BFC_ERR_OPTIONS, "AArch64 code can only be written as assembly");
+        }
+        if (out->profile && out->format != FORMAT_INTERPRET) {
+            fail(BFC_ERR_OPTIONS, "Profiling is not supported on AArch64");
+        }
+        if (out->safe && out->format != FORMAT_INTERPRET) {
+            fail(BFC_ERR_OPTIONS, "Safe mode is not supported on AArch64");
+        }
+        if (out->dump_tape && out->format != FORMAT_INTERPRET) {
+            fail(BFC_ERR_OPTIONS, "Tape dumps are not supported on AArch64");
+        }
+    }
+}
+
+bfc_status bfc_compile(const char *source, size_t length,
+                       const bfc_options *options, bfc_sink *sink) {
+    jmp_buf env;
+    if (setjmp(env) != 0) {
+        fail_target = NULL;
+        if (thread_compiler) {
+            release_mapping(thread_compiler);
+        }
+        return fail_status;
+    }
+    fail_target = &env;
+    
+    Options converted;
+    convert_options(options, &converted);
+    if (!sink && (converted.format == FORMAT_ASM || converted.format == FORMAT_ELF)) {
+        fail(BFC_ERR_OPTIONS, "No sink for the compiled output");
+    }
+    if (!thread_compiler) {
+        thread_compiler = create_compiler(&converted);
+    }
+    
+    // Memory from the previous call is dropped here rather than when that
+    // call ended, so failing out of a compilation leaks nothing
+    Compiler *c = thread_compiler;
+    reset_compiler(c);
+    c->options = converted;
+    
+    CountingSink counter = { sink, 0 };
+    bfc_sink counting_sink = { count_write, &counter };
+    bfc_sink *output = options->stats && sink ? &counting_sink : sink;
+    if (options->stats) {
+        memset(options->stats, 0, sizeof(bfc_stats));
+        options->stats->source_bytes = length;
+        c->stats = options->stats;
+    }
+    c->sink = output;
+    
+    // A cache hit is copied straight to the sink; a miss is compiled
+    // through a capturing sink and stored. Builds that write or use a
+    // profile, and --safe builds, are not cached: the key covers neither
+    // the file name and source positions they report nor the profile.
+    char path[PATH_MAX];
+    Buffer canonical;
+    CacheCapture capture;
+    bfc_sink capture_sink = { capture_write, &capture };
+    bool cached = options->cache_dir && output && !converted.profile && !converted.use_profile &&
+                  !converted.safe;
+    if (cached) {
+        double start = now_ms();
+        canonical = canonical_source(&c->arena, source, length);
+        snprintf(path, sizeof(path), "%s/%016llx", options->cache_dir,
+                 (unsigned long long)cache_key(&converted, &canonical));
+        bool hit = cache_fetch(&c->arena, path, &canonical, output);
+        record_phase(c, "cache", start, 0, 0);
+        if (hit) {
+            if (c->stats) {
+                c->stats->cache_hit = 1;
+                c->stats->memory_bytes = arena_used(&c->arena);
+                c->stats->output_bytes = counter.bytes;
+            }
+            fail_target = NULL;
+            fail_message[0] = '\0';
+            return BFC_OK;
+        }
+        capture.sink = output;
+        capture.copy = (Buffer){ &c->arena, NULL, 0, 0 };
+        c->sink = &capture_sink;
+    }
+    
+    Source *src = arena_alloc(&c->arena, sizeof(Source));
+    src->code = source;
+    src->length = length;
+    src->position = 0;
+    src->mapped = false;
+    src->name = options->name ? options->name : "<input>";
+    src->brackets = NULL;
+    src->bracket_count = 0;
+    compile(c, src);
+    if (cached) {
+        cache_store(options->cache_dir, path, &canonical, &capture.copy);
+    }
+    if (c->stats) {
+        c->stats->memory_bytes = arena_used(&c->arena);
+        c->stats->output_bytes = counter.bytes;
+    }
+    
+    fail_target = NULL;
+    fail_message[0] = '\0';
+    return BFC_OK;
+}
+
+const char *bfc_error_message(void) {
+    return fail_message;
+}
+
+void bfc_release(void) {
+    if (thread_compiler) {
+        free_compiler(thread_compiler);
+        thread_compiler = NULL;
+    }
+}
+
+#ifndef BFC_LIBRARY
+
+// Read source file. Regular files are mapped rather than copied; pipes,
+// terminals and "-" (stdin) are read in growing chunks.
+static Source *read_source(Arena *arena, const char *filename) {
+    bool from_stdin = strcmp(filename, "-") == 0;
+    int fd = from_stdin ? 0 : open(filename, O_RDONLY);
+    if (fd < 0) {
+        fail(BFC_ERR_IO, "Could not open file: %s", filename);
+    }
+    
+    Source *src = arena_alloc(arena, sizeof(Source));
+    src->position = 0;
+    src->mapped = false;
+    src->name = from_stdin ? "<stdin>" : filename;
+    src->brackets = NULL;
+    src->bracket_count = 0;
+    
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        void *code = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (code != MAP_FAILED) {
+            madvise(code, (size_t)st.st_size, MADV_SEQUENTIAL);
+            src->code = code;
+            src->length = (size_t)st.st_size;
+            src->mapped = true;
+            if (!from_stdin) close(fd);
+            return src;
+        }
+    }
+    
+    size_t capacity = 0;
+    size_t length = 0;
+    char *code = NULL;
+    for (;;) {
+        code = grow_array(arena, code, &capacity, length + INPUT_BUFFER_SIZE, 1);
+        
+        ssize_t n = read(fd, code + length, capacity - length);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) {
+            if (!from_stdin) close(fd);
+            fail(BFC_ERR_IO, "Could not read file: %s", filename);
+        }
+        if (n == 0) break;
+        length += (size_t)n;
+    }
+    if (!from_stdin) close(fd);
+    
+    src->code = code;
+    src->length = length;
+    return src;
+}
+
+// Unmap a mapped source; everything else it holds lives in the arena
+static void free_source(Source *src) {
+    if (src->mapped) {
+        munmap((void *)src->code, src->length);
+    }
+}
+
+static int usage(const char *program) {
+    fprintf(stderr, "Usage: %s [options] <input.bf|-> [output.s]\n", program);
+    fprintf(stderr, "       %s --batch [-j N] [options] <dir> [output-dir]\n", program);
+    fprintf(stderr, "Compiles Brainfuck code to x86-64 or AArch64 assembly, or a static x86-64\n");
+    fprintf(stderr, "ELF executable\n\n");
+    fprintf(stderr, "Options:\n");
+    fprintf(stderr, "  --eof=unchanged|0|-1  value ',' stores at end of input (default: unchanged)\n");
+    fprintf(stderr, "  --tape-size=N[K|M|G]  number of tape cells (default: %d)\n", MEMORY_SIZE);
+    fprintf(stderr, "  --tape=static|mmap    tape in .bss, or mapped on demand between guard pages\n");
+    fprintf(stderr, "  --safe                report tape accesses out of bounds with their position\n");
+    fprintf(stderr, "  -O0 .. -O3            optimization level (default: -O3)\n");
+    fprintf(stderr, "  --dump-tape           write the tape's cells to stderr when the program ends\n");
+    fprintf(stderr, "  --cell-size=8|16|32   bits per cell (default: 8)\n");
+    fprintf(stderr, "  --elf                 write a static executable instead of assembly\n");
+    fprintf(stderr, "  --run                 compile into memory and run immediately\n");
+    fprintf(stderr, "  --interpret           run the optimized IR without generating code\n");
+    fprintf(stderr, "  --target=x86-64|aarch64  architecture to generate (default: x86-64)\n");
+    fprintf(stderr, "  --cache=DIR           reuse output for programs compiled before\n");
+    fprintf(stderr, "  --profile[=FILE]      count loop runs, written at exit (default: bfc-profile.json)\n");
+    fprintf(stderr, "  --use-profile FILE    align and unroll the hot loops of a --profile run\n");
+    fprintf(stderr, "  --stats[=text|json]   print pass times, IR sizes and loop counts to stderr\n");
+    fprintf(stderr, "  --batch               compile every .bf/.b file in a directory\n");
+    fprintf(stderr, "  -j N                  worker threads for --batch (default: one per CPU)\n");
+    return 1;
+}
+
+// Parse a size with an optional binary K/M/G suffix
+static bool parse_size(const char *text, size_t *size) {
+    char *end;
+    unsigned long long value = strtoull(text, &end, 10);
+    
+    if (end == text || text[0] == '-') {
+        return false;
+    }
+    
+    switch (*end) {
+        case 'K': case 'k': value <<= 10; end++; break;
+        case 'M': case 'm': value <<= 20; end++; break;
+        case 'G': case 'g': value <<= 30; end++; break;
+    }
+    
+    if (*end != '\0' || value == 0 || value > MAX_TAPE_SIZE) {
+        return false;
+    }
+    *size = (size_t)value;
+    return true;
+}
+
+// Output file, created on the first write so that a program rejected by
+// the front end does not create or truncate it
+typedef struct {
+    const char *path;
+    bool executable;
+    FILE *file;
+    bool open_failed;
+} OutputFile;
+
+static int write_output_file(void *context, const void *data, size_t size) {
+    OutputFile *out = context;
+    if (!out->file) {
+        out->file = fopen(out->path, out->executable ? "wb" : "w");
+        if (!out->file) {
+            out->open_failed = true;
+            return -1;
+        }
+    }
+    return fwrite(data, 1, size, out->file) == size ? 0 : -1;
+}
+
+// Close the output of a finished compilation and report its error, if any
+static bool close_output(OutputFile *out, bfc_status status, const char *message) {
+    if (out->file && fclose(out->file) != 0 && status == BFC_OK) {
+        status = BFC_ERR_IO;
+        message = "Could not write output file";
+    }
+    if (status == BFC_ERR_IO && out->open_failed) {
+        fprintf(stderr, "Could not open output file: %s\n", out->path);
+    } else if (status != BFC_OK && status != BFC_ERR_RUNTIME) {
+        fprintf(stderr, "%s\n", message);
+    } else if (out->executable) {
+        chmod(out->path, 0755);
+    }
+    out->file = NULL;
+    return status == BFC_OK;
+}
+
+// How --stats prints its record
+typedef enum {
+    STATS_NONE,
+    STATS_TEXT,
+    STATS_JSON      // one object per line
+} StatsFormat;
+
+static void buffer_printf(Buffer *b, const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    buffer_vprintf(b, format, args);
+    va_end(args);
+}
+
+// Print the statistics of one compilation in a single write, so that the
+// records of --batch workers do not interleave
+static void print_stats(StatsFormat format, const char *name, const bfc_stats *stats, double read_ms) {
+    Arena arena = { NULL, NULL };
+    Buffer b = { &arena, NULL, 0, 0 };
+    struct rusage usage;
+    long peak_rss = getrusage(RUSAGE_SELF, &usage) == 0 ? usage.ru_maxrss : 0;
+    double total = read_ms;
+    for (int i = 0; i < stats->phase_count; i++) {
+        total += stats->phases[i].ms;
+    }
+    
+    if (format == STATS_JSON) {
+        buffer_str(&b, "{\"source\":");
+        buffer_json_string(&b, name);
+        buffer_printf(&b, ",\"source_bytes\":%zu,\"phases\":[{\"name\":\"read\",\"ms\":%.3f}",
+                      stats->source_bytes, read_ms);
+        for (int i = 0; i < stats->phase_count; i++) {
+            const bfc_phase_stats *phase = &stats->phases[i];
+            buffer_printf(&b, ",{\"name\":\"%s\",\"ms\":%.3f,\"ops_before\":%zu,\"ops_after\":%zu}",
+                          phase->name, phase->ms, phase->ops_before, phase->ops_after);
+        }
+        buffer_printf(&b, "],\"total_ms\":%.3f,\"loops\":{\"scan\":%zu,\"clear\":%zu,"
+                      "\"multiply\":%zu,\"dead\":%zu,\"remaining\":%zu}", total, stats->scan_loops,
+                      stats->clear_loops, stats->mul_loops, stats->dead_loops, stats->loops);
+        buffer_printf(&b, ",\"memory_bytes\":%zu,\"peak_rss_kb\":%ld,\"output_bytes\":%zu,\"cache_hit\":%s}\n",
+                      stats->memory_bytes, peak_rss, stats->output_bytes,
+                      stats->cache_hit ? "true" : "false");
+    } else {
+        buffer_printf(&b, "Statistics for %s (%zu bytes)\n", name, stats->source_bytes);
+        buffer_printf(&b, "  %-14s %10.3f ms\n", "read", read_ms);
+        for (int i = 0; i < stats->phase_count; i++) {
+            const bfc_phase_stats *phase = &stats->phases[i];
+            buffer_printf(&b, "  %-14s %10.3f ms", phase->name, phase->ms);
+            if (phase->ops_before || phase->ops_after) {
+                buffer_printf(&b, " %10zu -> %zu ops", phase->ops_before, phase->ops_after);
+            }
+            buffer_str(&b, "\n");
+        }
+        buffer_printf(&b, "  %-14s %10.3f ms\n", "total", total);
+        if (!stats->cache_hit) {
+            buffer_printf(&b, "  loops: %zu scan, %zu clear, %zu multiply, %zu dead, %zu left\n",
+                          stats->scan_loops, stats->clear_loops, stats->mul_loops,
+                          stats->dead_loops, stats->loops);
+        }
+        buffer_printf(&b, "  memory: %zu bytes in the compiler, %ld KB peak RSS\n",
+                      stats->memory_bytes, peak_rss);
+        buffer_printf(&b, "  output: %zu bytes%s\n", stats->output_bytes,
+                      stats->cache_hit ? " from the cache" : "");
+    }
+    
+    fwrite(b.bytes, 1, b.size, stderr);
+    arena_release(&arena);
+}
+
+// Files of a --batch run, handed out to the workers one at a time
+typedef struct {
+    const char *dir;
+    const char *out_dir;
+    const bfc_options *options;
+    StatsFormat stats;
+    char **names;
+    size_t count;
+    atomic_size_t next;
+    atomic_size_t failed;
+} Batch;
+
+// Brainfuck sources are recognized by their extension
+static bool is_source_name(const char *name) {
+    const char *dot = strrchr(name, '.');
+    return name[0] != '.' && dot && (strcmp(dot, ".bf") == 0 || strcmp(dot, ".b") == 0);
+}
+
+// Compile one file of the batch; its errors are reported and counted, and
+// the batch carries on
+static bool batch_compile(Batch *batch, Arena *input, const char *name) {
+    char in_path[PATH_MAX];
+    char out_path[PATH_MAX];
+    int stem = (int)(strrchr(name, '.') - name);
+    bool executable = batch->options->format == BFC_FORMAT_ELF;
+    
+    snprintf(in_path, sizeof(in_path), "%s/%s", batch->dir, name);
+    snprintf(out_path, sizeof(out_path), "%s/%.*s%s", batch->out_dir, stem, name,
+             executable ? "" : ".s");
+    
+    // A file that cannot be read only fails itself
+    jmp_buf env;
+    if (setjmp(env) != 0) {
+        fail_target = NULL;
+        fprintf(stderr, "%s\n", fail_message);
+        return false;
+    }
+    fail_target = &env;
+    arena_reset(input);
+    double start = now_ms();
+    Source *src = read_source(input, in_path);
+    double read_ms = now_ms() - start;
+    fail_target = NULL;
+    
+    bfc_options options = *batch->options;
+    bfc_stats stats;
+    options.name = in_path;
+    options.stats = batch->stats != STATS_NONE ? &stats : NULL;
+    OutputFile out = { out_path, executable, NULL, false };
+    bfc_sink sink = { write_output_file, &out };
+    bfc_status status = bfc_compile(src->code, src->length, &options, &sink);
+    free_source(src);
+    
+    bool ok = close_output(&out, status, bfc_error_message());
+    if (ok && options.stats) {
+        print_stats(batch->stats, in_path, &stats, read_ms);
+    }
+    return ok;
+}
+
+// Worker thread: its bfc_compile state and input arena are its own and are
+// reused for every file it takes
+static void *batch_worker(void *arg) {
+    Batch *batch = arg;
+    Arena input = { NULL, NULL };
+    
+    for (;;) {
+        size_t i = atomic_fetch_add(&batch->next, 1);
+        if (i >= batch->count) break;
+        if (!batch_compile(batch, &input, batch->names[i])) {
+            atomic_fetch_add(&batch->failed, 1);
+        }
+    }
+    
+    arena_release(&input);
+    bfc_release();
+    return NULL;
+}
+
+static int compare_names(const void *a, const void *b) {
+    return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+// Compile every source file in `dir` into `out_dir` on `jobs` threads
+static int run_batch(const char *dir, const char *out_dir, const bfc_options *options,
+                     StatsFormat stats, int jobs) {
+    DIR *d = opendir(dir);
+    if (!d) {
+        fprintf(stderr, "Could not open directory: %s\n", dir);
+        return 1;
+    }
+    
+    Arena names = { NULL, NULL };
+    Batch batch = { dir, out_dir, options, stats, NULL, 0, 0, 0 };
+    size_t capacity = 0;
+    struct dirent *entry;
+    while ((entry = readdir(d)) != NULL) {
+        if (!is_source_name(entry->d_name)) continue;
+        size_t length = strlen(entry->d_name) + 1;
+        char *name = arena_alloc(&names, length);
+        memcpy(name, entry->d_name, length);
+        batch.names = grow_array(&names, batch.names, &capacity, batch.count + 1, sizeof(char *));
+        batch.names[batch.count++] = name;
+    }
+    closedir(d);
+    if (batch.count > 1) {
+        qsort(batch.names, batch.count, sizeof(char *), compare_names);
+    }
+    
+    if (jobs > (int)batch.count) jobs = batch.count ? (int)batch.count : 1;
+    pthread_t *threads = arena_alloc(&names, sizeof(pthread_t) * (size_t)jobs);
+    int started = 0;
+    for (; started < jobs; started++) {
+        if (pthread_create(&threads[started], NULL, batch_worker, &batch) != 0) break;
+    }
+    if (started == 0) {
+        batch_worker(&batch);
+    }
+    for (int i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    
+    size_t failed = atomic_load(&batch.failed);
+    printf("Compiled %zu of %zu files from %s into %s (%d jobs)\n",
+           batch.count - failed, batch.count, dir, out_dir, started ? started : 1);
+    arena_release(&names);
+    return failed ? 1 : 0;
+}
+
+int main(int argc, char *argv[]) {
+    bfc_options options = {
+        .format = BFC_FORMAT_ASM,
+        .eof_mode = BFC_EOF_UNCHANGED,
+        .tape_mode = BFC_TAPE_STATIC,
+        .tape_size = MEMORY_SIZE,
+        .cell_bits = 8
+    };
+    const char *input_file = NULL;
+    const char *output_file = NULL;
+    int positional = 0;
+    bool batch = false;
+    int jobs = 0;
+    StatsFormat stats_format = STATS_NONE;
+    
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        
+        if (strncmp(arg, "--eof=", 6) == 0) {
+            const char *mode = arg + 6;
+            if (strcmp(mode, "unchanged") == 0) {
+                options.eof_mode = BFC_EOF_UNCHANGED;
+            } else if (strcmp(mode, "0") == 0) {
+                options.eof_mode = BFC_EOF_ZERO;
+            } else if (strcmp(mode, "-1") == 0) {
+                options.eof_mode = BFC_EOF_MINUS_ONE;
+            } else {
+                fprintf(stderr, "Unknown EOF mode: %s\n", mode);
+                return usage(argv[0]);
+            }
+        } else if (strncmp(arg, "--tape-size=", 12) == 0) {
+            if (!parse_size(arg + 12, &options.tape_size)) {
+                fprintf(stderr, "Invalid tape size: %s\n", arg + 12);
+                return usage(argv[0]);
+            }
+        } else if (strncmp(arg, "--cell-size=", 12) == 0) {
+            int bits = atoi(arg + 12);
+            if (bits != 8 && bits != 16 && bits != 32) {
+                fprintf(stderr, "Invalid cell size: %s\n", arg + 12);
+                return usage(argv[0]);
+            }
+            options.cell_bits = bits;
+        } else if (strcmp(arg, "--tape=static") == 0) {
+            options.tape_mode = BFC_TAPE_STATIC;
+        } else if (strcmp(arg, "--tape=mmap") == 0) {
+            options.tape_mode = BFC_TAPE_MMAP;
+        } else if (strcmp(arg, "--elf") == 0) {
+            options.format = BFC_FORMAT_ELF;
+        } else if (strcmp(arg, "--run") == 0) {
+            options.format = BFC_FORMAT_RUN;
+        } else if (strcmp(arg, "--safe") == 0) {
+            options.safe = 1;
+        } else if (strcmp(arg, "--dump-tape") == 0) {
+            options.dump_tape = 1;
+        } else if (strncmp(arg, "-O", 2) == 0 && arg[2] >= '0' && arg[2] <= '3' && !arg[3]) {
+            options.opt_level = (bfc_opt_level)(BFC_OPT_0 + (arg[2] - '0'));
+        } else if (strcmp(arg, "--interpret") == 0) {
+            options.format = BFC_FORMAT_INTERPRET;
+        } else if (strcmp(arg, "--target=x86-64") == 0) {
+            options.target = BFC_TARGET_X86_64;
+        } else if (strcmp(arg, "--target=aarch64") == 0) {
+            options.target = BFC_TARGET_AARCH64;
+        } else if (strncmp(arg, "--cache=", 8) == 0) {
+            options.cache_dir = arg + 8;
+        } else if (strcmp(arg, "--profile") == 0) {
+            options.profile_path = "bfc-profile.json";
+        } else if (strncmp(arg, "--profile=", 10) == 0) {
+            options.profile_path = arg + 10;
+        } else if (strncmp(arg, "--use-profile=", 14) == 0) {
+            options.use_profile = arg + 14;
+        } else if (strcmp(arg, "--use-profile") == 0 && i + 1 < argc) {
+            options.use_profile = argv[++i];
+        } else if (strcmp(arg, "--stats") == 0 || strcmp(arg, "--stats=text") == 0) {
+            stats_format = STATS_TEXT;
+        } else if (strcmp(arg, "--stats=json") == 0) {
+            stats_format = STATS_JSON;
+        } else if (strcmp(arg, "--batch") == 0) {
+            batch = true;
+        } else if (strncmp(arg, "-j", 2) == 0) {
+            const char *count = arg[2] ? arg + 2 : (i + 1 < argc ? argv[++i] : "");
+            jobs = atoi(count);
+            if (jobs <= 0) {
+                fprintf(stderr, "Invalid job count: %s\n", count);
+                return usage(argv[0]);
+            }
+        } else if (strncmp(arg, "--", 2) == 0) {
+            fprintf(stderr, "Unknown option: %s\n", arg);
+            return usage(argv[0]);
+        } else if (positional == 0) {
+            input_file = arg;
+            positional++;
+        } else if (positional == 1) {
+            output_file = arg;
+            positional++;
+        } else {
+            return usage(argv[0]);
+        }
+    }
+    
+    if (!input_file) {
+        return usage(argv[0]);
+    }
+    
+    bool in_process = options.format == BFC_FORMAT_RUN || options.format == BFC_FORMAT_INTERPRET;
+    if (batch) {
+        if (in_process) {
+            fprintf(stderr, "--batch writes files; it cannot be combined with --run or --interpret\n");
+            return usage(argv[0]);
+        }
+        if (jobs == 0) {
+            long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+            jobs = cpus > 0 ? (int)cpus : 1;
+        }
+        return run_batch(input_file, output_file ? output_file : input_file, &options,
+                         stats_format, jobs);
+    }
+    if (!output_file) {
+        output_file = options.format == BFC_FORMAT_ELF ? "a.out" : "output.s";
+    }
+    
+    Arena input = { NULL, NULL };
+    double start = now_ms();
+    Source *src = read_source(&input, input_file);
+    double read_ms = now_ms() - start;
+    options.name = src->name;
+    bfc_stats stats;
+    if (stats_format != STATS_NONE) {
+        options.stats = &stats;
+    }
+    
+    // The program owns stdout when it runs in-process
+    OutputFile out = { output_file, options.format == BFC_FORMAT_ELF, NULL, false };
+    bfc_sink sink = { write_output_file, &out };
+    bfc_status status = bfc_compile(src->code, src->length, &options, in_process ? NULL : &sink);
     
-    free_compiler(compiler);
     free_source(src);
+    arena_release(&input);
+    
+    bool ok = close_output(&out, status, bfc_error_message());
+    bfc_release();
+    if (ok && options.stats) {
+        print_stats(stats_format, options.name, &stats, read_ms);
+    }
+    if (!ok || in_process) {
+        return ok ? 0 : 1;
+    }
+    
+    printf("Brainfuck Compiler\n");
+    printf("Input:  %s\n", input_file);
+    printf("Output: %s\n", output_file);
+    printf("Compilation successful!\n");
+    if (options.format == BFC_FORMAT_ELF) {
+        printf("\nTo run:\n");
+        printf("  ./%s\n", output_file);
+    } else if (options.target == BFC_TARGET_AARCH64) {
+        printf("\nTo assemble and run on AArch64 Linux:\n");
+        printf("  as %s -o output.o\n", output_file);
+        printf("  ld output.o -o program\n");
+        printf("  ./program\n");
+        printf("(or aarch64-linux-gnu-as and aarch64-linux-gnu-ld elsewhere)\n");
+    } else {
+        printf("\nTo assemble and run:\n");
+        printf("  as %s -o output.o\n", output_file);
+        printf("  ld output.o -o program\n");
+        printf("  ./program\n");
+    }
     
     return 0;
 }
+
+#endif
@@ -0,0 +1,127 @@
+/*
+ * libbfc - the Brainfuck compiler as a library
+ * Compiles a program held in memory and hands the assembly text or ELF
+ * image to a caller-supplied sink, or runs it in this process. Errors are
+ * returned as status codes; the library never exits the process or thread.
+ */
+
+#ifndef BFC_H
+#define BFC_H
+
+#include <stddef.h>
+
+typedef enum {
+    BFC_OK = 0,
+    BFC_ERR_SYNTAX,     // unmatched bracket
+    BFC_ERR_OPTIONS,    // invalid bfc_options, or no sink for an output format
+    BFC_ERR_LIMIT,      // program exceeds a limit of the code generator
+    BFC_ERR_MEMORY,     // allocation or mapping failed
+    BFC_ERR_IO,         // the sink or a file reported an error
+    BFC_ERR_INTERNAL,   // bug in the compiler
+    BFC_ERR_RUNTIME     // a program run in this process could not write its
+                        // output or accessed the tape out of bounds
+} bfc_status;
+
+typedef enum {
+    BFC_FORMAT_ASM,         // AT&T assembly for as/ld
+    BFC_FORMAT_ELF,         // static x86-64 ELF executable
+    BFC_FORMAT_RUN,         // compile into memory and run in this process
+    BFC_FORMAT_INTERPRET    // run in the interpreter in this process
+} bfc_format;
+
+typedef enum {
+    BFC_EOF_UNCHANGED,      // ',' at end of input leaves the cell alone
+    BFC_EOF_ZERO,           // stores 0
+    BFC_EOF_MINUS_ONE       // stores -1
+} bfc_eof_mode;
+
+typedef enum {
+    BFC_TAPE_STATIC,        // zero-filled .bss array
+    BFC_TAPE_MMAP           // anonymous mapping between guard pages
+} bfc_tape_mode;
+
+typedef enum {
+    BFC_TARGET_X86_64,      // every output format
+    BFC_TARGET_AARCH64      // BFC_FORMAT_ASM only, in GNU as syntax
+} bfc_target;
+
+typedef enum {
+    BFC_OPT_DEFAULT,        // the same as BFC_OPT_3
+    BFC_OPT_0,              // no optimization passes: the IR as parsed
+    BFC_OPT_1,              // runs combined, scan, clear and multiply loops lowered
+    BFC_OPT_2,              // and offsets folded, the start of the program evaluated
+    BFC_OPT_3               // and loop cells kept in registers, walking loops unrolled
+} bfc_opt_level;
+
+// One step of a compilation: reading the source into IR, an optimization
+// pass, or generating and writing the output
+typedef struct {
+    const char *name;       // "parse", a pass such as "mul_loops", "emit", ...
+    double ms;              // wall-clock time
+    size_t ops_before;      // IR operations going in
+    size_t ops_after;       // and coming out
+} bfc_phase_stats;
+
+#define BFC_MAX_PHASES 16
+
+// Filled in by bfc_compile when bfc_options.stats is set. Loops are counted
+// when a pass recognizes them, so a loop the prefix evaluator later removes
+// is still counted. With BFC_FORMAT_RUN and BFC_FORMAT_INTERPRET, the
+// program's own run is the last phase.
+typedef struct {
+    bfc_phase_stats phases[BFC_MAX_PHASES];
+    int phase_count;        // only "cache" when the output came from the cache
+    size_t source_bytes;
+    size_t scan_loops;      // [>], [<<] and other scans
+    size_t clear_loops;     // [-] and [+]
+    size_t mul_loops;       // [->+<] and other multiply loops
+    size_t dead_loops;      // loops removed because their cell is known to be zero
+    size_t loops;           // loops left for the backend
+    size_t memory_bytes;    // compiler memory in use at the end, which is its peak
+    size_t output_bytes;    // bytes handed to the sink
+    int cache_hit;          // nonzero when the output came from cache_dir
+} bfc_stats;
+
+// Zero-initialized options select the defaults: assembly output, 30000
+// 8-bit cells in .bss, EOF leaves the cell unchanged
+typedef struct {
+    bfc_format format;
+    bfc_eof_mode eof_mode;
+    bfc_tape_mode tape_mode;
+    size_t tape_size;       // cells, 0 for the default
+    int cell_bits;          // 8, 16 or 32, 0 for the default of 8
+    const char *name;       // source name in diagnostics, NULL for "<input>"
+    const char *cache_dir;  // compilation cache directory, NULL for none
+    const char *profile_path;   // loop counts are written here at exit, NULL for none
+    const char *use_profile;    // counts from a profile_path run to optimize for, NULL for none
+    bfc_target target;      // architecture of the generated code
+    int safe;               // nonzero to report tape accesses out of bounds
+    bfc_opt_level opt_level;
+    int dump_tape;          // nonzero to write the tape's cells to stderr at exit
+    bfc_stats *stats;       // filled in when not NULL
+} bfc_options;
+
+// Receives the output in order. write returns 0 on success; anything else
+// aborts the compilation with BFC_ERR_IO.
+typedef struct bfc_sink {
+    int (*write)(void *context, const void *data, size_t size);
+    void *context;
+} bfc_sink;
+
+// Compile `length` bytes of source. The output goes to `sink`, which may be
+// NULL for the formats that run the program in this process; those
+// read stdin and write stdout. When such a program fails it writes its
+// message to stderr, as an executable would, and bfc_compile returns
+// BFC_ERR_RUNTIME. Each thread keeps its compiler state and reuses its
+// memory on the next call.
+bfc_status bfc_compile(const char *source, size_t length,
+                       const bfc_options *options, bfc_sink *sink);
+
+// Message for the last failed bfc_compile on this thread, e.g.
+// "prog.bf:3:5: error: unmatched ']'"
+const char *bfc_error_message(void);
+
+// Free the calling thread's compiler state
+void bfc_release(void);
+
+#endif
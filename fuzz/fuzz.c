@@ -0,0 +1,528 @@
+/*
+ * bfc differential fuzzer
+ * Generates random programs whose loops always terminate and runs each one
+ * through several builds of a bfc binary. The unoptimized native build
+ * (-O0 --elf) is the reference; native code, --run and --interpret at the
+ * optimization levels under test must match its output, exit status and
+ * final tape (--dump-tape). Cell size, tape, end of input, --safe and
+ * --dump-tape vary between programs. Programs that disagree are kept for
+ * replay.
+ * Usage: fuzz [-n programs] [-s seed] [-O level] BFC
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <limits.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+
+#define DEFAULT_PROGRAMS 100
+#define MAX_ARGS 16
+#define MAX_DEPTH 3             // loop nesting
+#define MAX_STATEMENTS 12       // per loop body; programs have four times as many
+#define CELL_RANGE 24           // cells either side of the start cell a program touches
+#define TAPE_CELLS 256          // the start cell is in the middle
+#define TAPE_SIZE_TEXT "256"
+#define MAX_INPUT_BYTES 16      // stdin per program
+#define CPU_LIMIT 10            // seconds per run
+
+typedef enum {
+    BACKEND_NATIVE,         // --elf, then the executable is run
+    BACKEND_JIT,            // --run
+    BACKEND_INTERPRETER,    // --interpret
+    BACKEND_COUNT
+} Backend;
+
+static const char *backend_names[BACKEND_COUNT] = { "native", "jit", "interpreter" };
+static const char *backend_flags[BACKEND_COUNT] = { "--elf", "--run", "--interpret" };
+
+// What one run left behind
+typedef struct {
+    int status;             // exit status, or 128 + signal
+    char *output;           // stdout
+    size_t output_length;
+    char *tape;             // stderr: the --dump-tape cells if given, or an error message
+    size_t tape_length;
+} Result;
+
+// Program text being generated. Positions are cells relative to the start
+// cell; the cells counting the enclosing loops are never written.
+typedef struct {
+    char *text;
+    size_t length;
+    size_t capacity;
+    uint64_t state;
+    int pos;
+    int counters[MAX_DEPTH];
+    int depth;
+    bool reads;             // the program reads input
+    bool input_counts;      // loops may count input bytes
+    bool wide;              // 32-bit cells: values only grow, so clears stay short
+} Generator;
+
+uint32_t next_random(Generator *g) {
+    g->state = g->state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return (uint32_t)(g->state >> 33);
+}
+
+int pick(Generator *g, int n) {
+    return (int)(next_random(g) % (uint32_t)n);
+}
+
+void emit(Generator *g, char ch, int count) {
+    while (g->length + (size_t)count + 1 > g->capacity) {
+        g->capacity = g->capacity ? g->capacity * 2 : 4096;
+        g->text = realloc(g->text, g->capacity);
+        if (!g->text) {
+            fprintf(stderr, "Out of memory\n");
+            exit(1);
+        }
+    }
+    memset(g->text + g->length, ch, (size_t)count);
+    g->length += (size_t)count;
+    g->text[g->length] = '\0';
+}
+
+void move_to(Generator *g, int target) {
+    emit(g, target > g->pos ? '>' : '<', abs(target - g->pos));
+    g->pos = target;
+}
+
+bool writable(const Generator *g) {
+    for (int k = 0; k < g->depth; k++) {
+        if (g->counters[k] == g->pos) return false;
+    }
+    return true;
+}
+
+void generate_block(Generator *g, int statements);
+
+// A counted loop on the current cell: it is cleared, set to a small
+// constant or an input byte, and counted down once per iteration by a body
+// that leaves it alone. Input counts are only used outermost and with
+// 8-bit cells, so nesting stays cheap even when end of input stores -1.
+void generate_loop(Generator *g) {
+    int counter = g->pos;
+    emit(g, '[', 1);
+    emit(g, '-', 1);
+    emit(g, ']', 1);
+    if (g->reads && g->input_counts && g->depth == 0 && pick(g, 2)) {
+        emit(g, ',', 1);
+    } else {
+        emit(g, '+', 1 + pick(g, 4));
+    }
+
+    bool count_first = pick(g, 2);
+    emit(g, '[', 1);
+    if (count_first) emit(g, '-', 1);
+    g->counters[g->depth++] = counter;
+    generate_block(g, 1 + pick(g, MAX_STATEMENTS));
+    g->depth--;
+    move_to(g, counter);
+    if (!count_first) emit(g, '-', 1);
+    emit(g, ']', 1);
+}
+
+// A loop that walks over a row of nonzero cells and stops at the zero cell
+// after it, moving `stride` cells per iteration without coming back. The
+// body only writes cells the walk has passed or that lie between its stops,
+// so every iteration lands on the next cell of the row.
+void generate_walk(Generator *g) {
+    int stride = 1 + pick(g, 3);
+    int cells = 1 + pick(g, 4);
+    int step = pick(g, 2) ? stride : -stride;
+    int start = g->pos;
+    int end = start + cells * step;
+    int low = step > 0 ? start - 2 : end;
+    int high = step > 0 ? end : start + 2;
+    if (low < -CELL_RANGE || high > CELL_RANGE) {
+        return;
+    }
+    for (int k = 0; k < g->depth; k++) {
+        if (g->counters[k] >= low && g->counters[k] <= high) return;
+    }
+
+    for (int j = 0; j < cells; j++) {
+        move_to(g, start + j * step);
+        emit(g, '[', 1);
+        emit(g, '-', 1);
+        emit(g, ']', 1);
+        emit(g, '+', 1 + pick(g, 3));
+    }
+    move_to(g, end);
+    emit(g, '[', 1);
+    emit(g, '-', 1);
+    emit(g, ']', 1);
+    move_to(g, start);
+
+    // Body positions are relative to the walk's current cell
+    emit(g, '[', 1);
+    g->pos = 0;
+    for (int i = 1 + pick(g, 4); i > 0; i--) {
+        int offset = pick(g, stride + 2) - 2;
+        move_to(g, step > 0 ? offset : -offset);
+        if (pick(g, 3) == 0) {
+            emit(g, '.', 1);
+        } else {
+            emit(g, g->wide || pick(g, 2) ? '+' : '-', 1 + pick(g, 3));
+        }
+    }
+    move_to(g, 0);
+    emit(g, step > 0 ? '>' : '<', stride);
+    emit(g, ']', 1);
+    g->pos = end;
+}
+
+void generate_block(Generator *g, int statements) {
+    for (int i = 0; i < statements; i++) {
+        switch (pick(g, 9)) {
+            case 0:
+            case 1:
+                if (writable(g)) emit(g, g->wide || pick(g, 2) ? '+' : '-', 1 + pick(g, 5));
+                break;
+            case 2:
+            case 3: {
+                int target = g->pos + pick(g, 9) - 4;
+                if (target < -CELL_RANGE) target = -CELL_RANGE;
+                if (target > CELL_RANGE) target = CELL_RANGE;
+                move_to(g, target);
+                break;
+            }
+            case 4:
+                emit(g, '.', 1);
+                break;
+            case 5:
+                if (g->reads && writable(g)) emit(g, ',', 1);
+                break;
+            case 6:
+                if (writable(g) && g->depth < MAX_DEPTH) generate_loop(g);
+                break;
+            case 7:
+                if (writable(g)) {
+                    emit(g, '[', 1);
+                    emit(g, g->wide || pick(g, 2) ? '-' : '+', 1);
+                    emit(g, ']', 1);
+                }
+                break;
+            case 8:
+                generate_walk(g);
+                break;
+        }
+        if (pick(g, 16) == 0) emit(g, '\n', 1);
+    }
+}
+
+// A program that starts in the middle of a TAPE_CELLS tape, may end with
+// a scan, and prints the cell it stops on. Scans only cross cells the
+// program touched, so they stay on the tape. A program that reads input
+// starts with ','; one that does not is evaluated at compile time as far
+// as the step limit allows.
+void generate_program(Generator *g) {
+    g->length = 0;
+    g->pos = 0;
+    g->depth = 0;
+    emit(g, '>', TAPE_CELLS / 2);
+    emit(g, '\n', 1);
+    if (g->reads) emit(g, ',', 1);
+    generate_block(g, 4 * MAX_STATEMENTS);
+    if (pick(g, 3) == 0) {
+        int stride = 1 + pick(g, 3);
+        emit(g, '[', 1);
+        emit(g, pick(g, 2) ? '>' : '<', stride);
+        emit(g, ']', 1);
+    }
+    emit(g, '.', 1);
+    emit(g, '\n', 1);
+}
+
+bool write_file(const char *path, const char *data, size_t length) {
+    FILE *f = fopen(path, "wb");
+    if (!f) {
+        return false;
+    }
+    bool ok = fwrite(data, 1, length, f) == length;
+    return fclose(f) == 0 && ok;
+}
+
+char *read_file(const char *path, size_t *length) {
+    FILE *f = fopen(path, "rb");
+    *length = 0;
+    if (!f) {
+        return NULL;
+    }
+    size_t capacity = 4096;
+    char *data = malloc(capacity);
+    size_t n;
+    while (data && (n = fread(data + *length, 1, capacity - *length, f)) > 0) {
+        *length += n;
+        if (*length == capacity) {
+            capacity *= 2;
+            data = realloc(data, capacity);
+        }
+    }
+    fclose(f);
+    return data;
+}
+
+// Run argv with stdin, stdout and stderr redirected to files (NULL for
+// /dev/null); returns the exit status, 128 + signal, or -1
+int run_process(char *const argv[], const char *in_path, const char *out_path, const char *err_path) {
+    pid_t pid = fork();
+    if (pid < 0) {
+        return -1;
+    }
+    if (pid == 0) {
+        int in = open(in_path ? in_path : "/dev/null", O_RDONLY);
+        int out = out_path ? open(out_path, O_WRONLY | O_CREAT | O_TRUNC, 0644)
+                           : open("/dev/null", O_WRONLY);
+        int err = err_path ? open(err_path, O_WRONLY | O_CREAT | O_TRUNC, 0644)
+                           : open("/dev/null", O_WRONLY);
+        if (in < 0 || out < 0 || err < 0 || dup2(in, 0) < 0 || dup2(out, 1) < 0 || dup2(err, 2) < 0) {
+            _exit(127);
+        }
+        struct rlimit limit = { CPU_LIMIT, CPU_LIMIT };
+        setrlimit(RLIMIT_CPU, &limit);
+        execv(argv[0], argv);
+        _exit(127);
+    }
+
+    int status;
+    if (waitpid(pid, &status, 0) < 0) {
+        return -1;
+    }
+    return WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+}
+
+// Options every build of one program shares; `safe` and `dump` are empty
+// when not given
+typedef struct {
+    const char *cell_size;
+    const char *tape;
+    const char *eof;
+    const char *safe;
+    const char *dump;
+} Config;
+
+static const char *cell_sizes[] = { "--cell-size=8", "--cell-size=16", "--cell-size=32" };
+static const char *tapes[] = { "--tape=static", "--tape=mmap" };
+static const char *eofs[] = { "--eof=unchanged", "--eof=0", "--eof=-1" };
+
+// Compile and run one program through one backend at one level
+Result run_build(const char *bfc, const Config *config, Backend backend, int level,
+                 const char *source, const char *input, const char *temp) {
+    Result r = { -1, NULL, 0, NULL, 0 };
+    char exe[PATH_MAX];
+    char out[PATH_MAX];
+    char err[PATH_MAX];
+    char opt[4];
+    char *argv[MAX_ARGS];
+    int argc = 0;
+
+    snprintf(exe, sizeof(exe), "%s/program", temp);
+    snprintf(out, sizeof(out), "%s/stdout", temp);
+    snprintf(err, sizeof(err), "%s/stderr", temp);
+    snprintf(opt, sizeof(opt), "-O%d", level);
+
+    argv[argc++] = (char *)bfc;
+    argv[argc++] = opt;
+    argv[argc++] = (char *)config->cell_size;
+    argv[argc++] = (char *)config->tape;
+    argv[argc++] = (char *)config->eof;
+    argv[argc++] = "--tape-size=" TAPE_SIZE_TEXT;
+    if (*config->safe) argv[argc++] = (char *)config->safe;
+    if (*config->dump) argv[argc++] = (char *)config->dump;
+    argv[argc++] = (char *)backend_flags[backend];
+    argv[argc++] = (char *)source;
+    if (backend == BACKEND_NATIVE) argv[argc++] = exe;
+    argv[argc] = NULL;
+
+    if (backend == BACKEND_NATIVE) {
+        unlink(exe);
+        if (run_process(argv, NULL, NULL, NULL) != 0) {
+            return r;       // a failed compile never matches
+        }
+        char *run_argv[] = { exe, NULL };
+        r.status = run_process(run_argv, input, out, err);
+    } else {
+        r.status = run_process(argv, input, out, err);
+    }
+    r.output = read_file(out, &r.output_length);
+    r.tape = read_file(err, &r.tape_length);
+    return r;
+}
+
+void free_result(Result *r) {
+    free(r->output);
+    free(r->tape);
+}
+
+bool same_bytes(const char *a, size_t a_length, const char *b, size_t b_length) {
+    return a_length == b_length && (a_length == 0 || memcmp(a, b, a_length) == 0);
+}
+
+// How a build differs from the reference, or NULL
+const char *difference(const Result *r, const Result *reference, const Config *config) {
+    if (r->status < 0) return "failed to compile or run";
+    if (r->status != reference->status) return "exit status differs";
+    if (!same_bytes(r->output, r->output_length, reference->output, reference->output_length)) {
+        return "output differs";
+    }
+    if (!same_bytes(r->tape, r->tape_length, reference->tape, reference->tape_length)) {
+        return *config->dump ? "final tape differs" : "stderr differs";
+    }
+    return NULL;
+}
+
+// Keep a failing program and its input in the current directory
+void save_case(uint64_t seed, int n, const Generator *g, const char *input, size_t input_length,
+               const Config *config, const char *build, const char *what) {
+    char path[64];
+    snprintf(path, sizeof(path), "fuzz-%llu-%d.b", (unsigned long long)seed, n);
+    write_file(path, g->text, g->length);
+    printf("%s (%s %s %s%s%s%s%s", path, config->cell_size, config->tape, config->eof,
+           *config->safe ? " " : "", config->safe, *config->dump ? " " : "", config->dump);
+    snprintf(path, sizeof(path), "fuzz-%llu-%d.in", (unsigned long long)seed, n);
+    if (input_length > 0) {
+        write_file(path, input, input_length);
+        printf(", input %s", path);
+    }
+    printf("): %s: %s\n", build, what);
+    fflush(stdout);
+}
+
+// Generate program `n` and check every build of it; returns the number of
+// builds that disagree with the reference
+int fuzz_one(const char *bfc, Generator *g, uint64_t seed, int n, const int *levels, int level_count,
+             const char *temp) {
+    char source[PATH_MAX];
+    char input_path[PATH_MAX];
+    char input[MAX_INPUT_BYTES];
+    int failed = 0;
+
+    // 32-bit cells never see -1 from input, so no value needs 2^32 steps
+    // to clear
+    int cell_size = pick(g, 3);
+    Config config = {
+        cell_sizes[cell_size], tapes[pick(g, 2)], eofs[pick(g, cell_size == 2 ? 2 : 3)],
+        pick(g, 3) == 0 ? "--safe" : "", pick(g, 4) ? "--dump-tape" : ""
+    };
+    g->reads = pick(g, 2);
+    g->input_counts = cell_size == 0;
+    g->wide = cell_size == 2;
+    generate_program(g);
+    size_t input_length = g->reads ? (size_t)pick(g, MAX_INPUT_BYTES + 1) : 0;
+    for (size_t i = 0; i < input_length; i++) {
+        input[i] = (char)(1 + pick(g, 255));
+    }
+
+    snprintf(source, sizeof(source), "%s/program.b", temp);
+    snprintf(input_path, sizeof(input_path), "%s/input", temp);
+    if (!write_file(source, g->text, g->length) || !write_file(input_path, input, input_length)) {
+        fprintf(stderr, "Could not write to %s\n", temp);
+        return 1;
+    }
+
+    Result reference = run_build(bfc, &config, BACKEND_NATIVE, 0, source, input_path, temp);
+    if (reference.status < 0) {
+        save_case(seed, n, g, input, input_length, &config, "native -O0", "failed to compile or run");
+        free_result(&reference);
+        return 1;
+    }
+    if (reference.status == 128 + SIGXCPU || reference.status == 128 + SIGKILL) {
+        fprintf(stderr, "Program %d ran out of CPU time at -O0, skipped\n", n);
+        free_result(&reference);
+        return 0;
+    }
+
+    for (int l = 0; l < level_count; l++) {
+        for (int b = 0; b < BACKEND_COUNT; b++) {
+            if (levels[l] == 0 && b == BACKEND_NATIVE) continue;
+            Result r = run_build(bfc, &config, (Backend)b, levels[l], source, input_path, temp);
+            const char *what = difference(&r, &reference, &config);
+            if (what) {
+                char build[32];
+                snprintf(build, sizeof(build), "%s -O%d", backend_names[b], levels[l]);
+                save_case(seed, n, g, input, input_length, &config, build, what);
+                failed++;
+            }
+            free_result(&r);
+        }
+    }
+
+    free_result(&reference);
+    return failed;
+}
+
+int usage(const char *program) {
+    fprintf(stderr, "Usage: %s [-n programs] [-s seed] [-O level] BFC\n", program);
+    fprintf(stderr, "Runs random programs (default %d) through the compiler BFC at -O0\n",
+            DEFAULT_PROGRAMS);
+    fprintf(stderr, "to -O3, or only at -O level, with the native, jit and interpreter\n");
+    fprintf(stderr, "backends, and compares output, exit status and final tape with the\n");
+    fprintf(stderr, "-O0 native build. Programs that differ are written to fuzz-SEED-N.b\n");
+    fprintf(stderr, "in the current directory. Exits with 1 if any build differs.\n");
+    return 1;
+}
+
+int main(int argc, char *argv[]) {
+    int programs = DEFAULT_PROGRAMS;
+    uint64_t seed = (uint64_t)time(NULL);
+    int levels[] = { 0, 1, 2, 3 };
+    int level_count = 4;
+    int arg = 1;
+
+    while (arg + 1 < argc && argv[arg][0] == '-') {
+        if (strcmp(argv[arg], "-n") == 0) {
+            programs = atoi(argv[arg + 1]);
+        } else if (strcmp(argv[arg], "-s") == 0) {
+            seed = strtoull(argv[arg + 1], NULL, 10);
+        } else if (strcmp(argv[arg], "-O") == 0 && argv[arg + 1][0] >= '0' &&
+                   argv[arg + 1][0] <= '3' && !argv[arg + 1][1]) {
+            levels[0] = argv[arg + 1][0] - '0';
+            level_count = 1;
+        } else {
+            return usage(argv[0]);
+        }
+        arg += 2;
+    }
+    if (argc - arg != 1 || programs < 1) {
+        return usage(argv[0]);
+    }
+    const char *bfc = argv[arg];
+
+    const char *tmpdir = getenv("TMPDIR");
+    char temp[PATH_MAX - 16];    // room for the file names below
+    snprintf(temp, sizeof(temp), "%s/bfc-fuzz.XXXXXX", tmpdir ? tmpdir : "/tmp");
+    if (!mkdtemp(temp)) {
+        fprintf(stderr, "Could not create a temporary directory in %s\n", tmpdir ? tmpdir : "/tmp");
+        return 1;
+    }
+
+    Generator g = { NULL, 0, 0, seed, 0, { 0 }, 0, false, false, false };
+    int failed = 0;
+    for (int n = 0; n < programs; n++) {
+        failed += fuzz_one(bfc, &g, seed, n, levels, level_count, temp);
+    }
+    printf("Ran %d programs from seed %llu: %d builds differed\n", programs,
+           (unsigned long long)seed, failed);
+
+    const char *files[] = { "program.b", "program", "input", "stdout", "stderr" };
+    for (size_t i = 0; i < sizeof(files) / sizeof(files[0]); i++) {
+        char path[PATH_MAX];
+        snprintf(path, sizeof(path), "%s/%s", temp, files[i]);
+        unlink(path);
+    }
+    rmdir(temp);
+    free(g.text);
+    return failed ? 1 : 0;
+}